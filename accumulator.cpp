@@ -0,0 +1,62 @@
+#include "accumulator.h"
+
+#include "fullscreen_quad.h"
+
+
+namespace {
+    // radical inverse of i in the given base, low discrepancy so any prefix of the sequence covers the pixel evenly
+    float halton(unsigned int i, unsigned int base) {
+        float f = 1.0f, r = 0.0f;
+        for (; i > 0; i /= base) {
+            f /= base;
+            r += f * (i % base);
+        }
+        return r;
+    }
+}
+
+
+Accumulator::Accumulator(int width, int height, GLenum internalFormat)
+    : sample(width, height, internalFormat),
+      history{RenderTarget(width, height, internalFormat), RenderTarget(width, height, internalFormat)},
+      resolveShader("shaders/default.vert", "shaders/post/accumulate.frag") {
+    state.width = width;
+    state.height = height;
+}
+
+void Accumulator::begin(const AccumulationState& next) {
+    if (next == state) return;
+
+    if (next.width != state.width || next.height != state.height) {
+        sample.resize(next.width, next.height);
+        history[0].resize(next.width, next.height);
+        history[1].resize(next.width, next.height);
+    }
+    state = next;
+    samples = 0;
+}
+
+void Accumulator::jitter(float& x, float& y) const {
+    x = samples == 0 ? 0.0f : halton(samples, 2) - 0.5f;
+    y = samples == 0 ? 0.0f : halton(samples, 3) - 0.5f;
+}
+
+void Accumulator::accumulate(const FullscreenQuad& quad) {
+    int next = 1 - current;
+    samples++;
+
+    history[next].bind();
+    resolveShader.use();
+    resolveShader.setInt("sampleTexture"_u, 0);
+    resolveShader.setInt("historyTexture"_u, 1);
+    resolveShader.setFloat("weight"_u, 1.0f / samples);             // the first sample replaces whatever history held
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sample.colorTexture());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, history[current].colorTexture());
+    quad.draw();
+    glActiveTexture(GL_TEXTURE0);
+
+    current = next;
+}
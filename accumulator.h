@@ -0,0 +1,49 @@
+#ifndef ACCUMULATOR_H
+#define ACCUMULATOR_H
+
+#include <glad/glad.h>
+
+#include "render_target.h"
+#include "shader.h"
+
+class FullscreenQuad;
+
+
+// Everything that makes two frames show the same image, accumulation restarts when any of it changes
+struct AccumulationState {
+    const Shader* program = nullptr;                                // covers the demo, its permutation and hot reloads
+    float time = 0.0f;
+    int width = 0, height = 0;
+
+    bool operator==(const AccumulationState&) const = default;
+};
+
+
+// Progressive rendering of a still: every frame renders one jittered sample into sampleTarget(),
+// accumulate() folds it into the running mean kept in two float targets used in turn (ping-pong).
+class Accumulator {
+    RenderTarget sample;
+    RenderTarget history[2];
+    int current = 0;                                                // history[current] holds the mean
+    unsigned int samples = 0;
+    AccumulationState state;
+    Shader resolveShader;
+
+public:
+    Accumulator(int width, int height, GLenum internalFormat = GL_RGBA32F);
+
+    // call before rendering a sample, restarts (and resizes) when the state differs from the last frame
+    void begin(const AccumulationState& next);
+    void reset() { samples = 0; }
+
+    // camera offset in pixels for the next sample, within [-0.5, 0.5], 0 for the first
+    void jitter(float& x, float& y) const;
+
+    const RenderTarget& sampleTarget() const { return sample; }
+    void accumulate(const FullscreenQuad& quad);                    // sampleTarget() must hold the new sample
+
+    const RenderTarget& result() const { return history[current]; }
+    unsigned int sampleCount() const { return samples; }
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "checkerboard.h"
+
+#include "fullscreen_quad.h"
+
+
+CheckerboardRenderer::CheckerboardRenderer(int width, int height)
+    : half((width + 1) / 2, height),
+      output{RenderTarget(width, height), RenderTarget(width, height)},
+      w(width), h(height),
+      resolveShader("shaders/default.vert", "shaders/post/checkerboard.frag") {}
+
+void CheckerboardRenderer::begin(const Shader* next, int width, int height) {
+    if (width != w || height != h) {
+        w = width;
+        h = height;
+        half.resize((w + 1) / 2, h);
+        output[0].resize(w, h);
+        output[1].resize(w, h);
+        historyValid = false;
+    }
+    if (next != program) {
+        program = next;
+        historyValid = false;
+    }
+}
+
+void CheckerboardRenderer::resolve(const FullscreenQuad& quad) {
+    int next = 1 - current;
+
+    output[next].bind();
+    resolveShader.use();
+    resolveShader.setInt("halfTexture"_u, 0);
+    resolveShader.setInt("historyTexture"_u, 1);
+    resolveShader.setBool("historyValid"_u, historyValid);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, half.colorTexture());
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, output[current].colorTexture());
+    quad.draw();
+    glActiveTexture(GL_TEXTURE0);
+
+    current = next;
+    historyValid = true;
+    frame++;
+}
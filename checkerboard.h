@@ -0,0 +1,39 @@
+#ifndef CHECKERBOARD_H
+#define CHECKERBOARD_H
+
+#include <glad/glad.h>
+
+#include "render_target.h"
+#include "shader.h"
+
+class FullscreenQuad;
+
+
+// Checkerboard rendering: programs built with CHECKERBOARD=1 shade half the pixels of a frame into a target
+// half as wide (see pixelCoord() in common.glsl), alternating which half every frame; resolve() rebuilds the
+// full frame from those samples and the previous output.
+class CheckerboardRenderer {
+    RenderTarget half;
+    RenderTarget output[2];
+    int current = 0;                                                // output[current] holds the last resolved frame
+    int frame = 0;
+    bool historyValid = false;
+    const Shader* program = nullptr;                                // history from another program is meaningless
+    int w, h;
+    Shader resolveShader;
+
+public:
+    CheckerboardRenderer(int width, int height);
+
+    // call before rendering, drops the history when the program or size changed
+    void begin(const Shader* program, int width, int height);
+
+    int frameIndex() const { return frame; }                        // FrameConstantsData::iFrame for this frame's samples
+    const RenderTarget& halfTarget() const { return half; }
+
+    // rebuilds the full frame, FrameConstants must still hold this frame's iResolution (full size) and iFrame
+    void resolve(const FullscreenQuad& quad);
+    const RenderTarget& result() const { return output[current]; }
+};
+
+#endif
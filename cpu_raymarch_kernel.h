@@ -0,0 +1,291 @@
+#ifndef CPU_RAYMARCH_KERNEL_H
+#define CPU_RAYMARCH_KERNEL_H
+
+#include <cmath>
+
+#include "cpu_raymarcher.h"
+#include "glsl_math.h"
+
+
+// Sphere tracing kernels of cpu_raymarcher.h, templated over the lane type F (float, float8 or float16).
+// Included by one .cpp per instruction set, everything is file local so each object keeps its own instantiations;
+// no std templates either, an out-of-line copy built for AVX-512 could otherwise end up shared with the scalar path.
+// Mirrors shaders/lib/{transform,sdf,lighting,raymarch}.glsl and the scenes of raymarch.frag and coolRaymarch.frag.
+namespace cpu {
+namespace {
+
+using namespace glsl;
+using glsl::abs, glsl::sqrt, glsl::min, glsl::max, glsl::clamp, glsl::sign;  // over the C library's, which <immintrin.h> brings along
+
+constexpr int MAX_STEPS = 100;                                      // as in raymarch.glsl
+constexpr float HIT_EPSILON = 0.001f;
+
+
+// ---- TRANSFORMS --------------------------------------
+
+mat3 rotateX(float angle) {
+    return mat3(1.0f, 0.0f, 0.0f,
+                0.0f, std::cos(angle), std::sin(angle),
+                0.0f, -std::sin(angle), std::cos(angle));
+}
+
+mat3 rotateY(float angle) {
+    return mat3(std::cos(angle), 0.0f, -std::sin(angle),
+                0.0f, 1.0f, 0.0f,
+                std::sin(angle), 0.0f, std::cos(angle));
+}
+
+mat3 rotateZ(float angle) {
+    return mat3(std::cos(angle), std::sin(angle), 0.0f,
+                -std::sin(angle), std::cos(angle), 0.0f,
+                0.0f, 0.0f, 1.0f);
+}
+
+// the rotations funcBox/funcBoxFrame and funcCylinder/funcHexPrism apply in turn, as one matrix per frame
+mat3 boxRotation(vec3 rot) { return rotateZ(rot.z) * rotateY(rot.y) * rotateX(rot.x); }
+mat3 prismRotation(vec3 rot) { return rotateZ(-rot.z) * rotateY(-rot.y) * rotateX(-rot.x); }
+
+
+// ---- SDF PRIMITIVES --------------------------------------
+// p is already moved into the primitive's frame by `rotation * (p - pos)`
+
+template <typename F> F funcSphere(tvec3<F> p, vec3 centre, float radius) {
+    return length(p - centre) - radius;
+}
+
+template <typename F> F funcBox(tvec3<F> p, vec3 b, vec3 pos, const mat3& rotation) {
+    p = rotation * (p - pos);
+    tvec3<F> q = abs(p) - b;
+    return length(max(q, 0.0f)) + min(max(q.x, max(q.y, q.z)), 0.0f);
+}
+
+template <typename F> F funcBoxFrame(tvec3<F> p, vec3 b, float e, vec3 pos, const mat3& rotation) {
+    p = rotation * (p - pos);
+    p = abs(p) - b;
+    tvec3<F> q = abs(p + e) - e;
+
+    return min(min(
+        length(max(tvec3<F>(p.x, q.y, q.z), 0.0f)) + min(max(p.x, max(q.y, q.z)), 0.0f),
+        length(max(tvec3<F>(q.x, p.y, q.z), 0.0f)) + min(max(q.x, max(p.y, q.z)), 0.0f)),
+        length(max(tvec3<F>(q.x, q.y, p.z), 0.0f)) + min(max(q.x, max(q.y, p.z)), 0.0f));
+}
+
+template <typename F> F funcCylinder(tvec3<F> p, float r, float h, vec3 pos, const mat3& rotation) {
+    p = rotation * (p - pos);
+    tvec2<F> d = abs(tvec2<F>(length(p.xz()), p.y)) - vec2(r, h);
+    return min(max(d.x, d.y), 0.0f) + length(max(d, 0.0f));
+}
+
+template <typename F> F funcHexPrism(tvec3<F> p, vec2 h, vec3 pos, const mat3& rotation) {
+    p = rotation * (p - pos);
+
+    const vec3 k(-0.8660254f, 0.5f, 0.57735f);
+    p = abs(p);
+    p = tvec3<F>(p.xy() - 2.0f * min(dot(k.xy(), p.xy()), 0.0f) * k.xy(), p.z);
+    tvec2<F> d(length(p.xy() - tvec2<F>(clamp(p.x, -k.z * h.x, k.z * h.x), h.x)) * sign(p.y - h.x), p.z - h.y);
+    return min(max(d.x, d.y), 0.0f) + length(max(d, 0.0f));
+}
+
+template <typename F> F smoothUnion(F d1, F d2, float k) {
+    k *= 4.0f;
+    F h = max(k - abs(d1 - d2), 0.0f);
+    return min(d1, d2) - h * h * 0.25f / k;
+}
+
+template <typename F> F smoothSubtraction(F d1, F d2, float k) {
+    k *= 4.0f;
+    F h = max(k - abs(d1 - d2), 0.0f);
+    return max(d1, -d2) + h * h * 0.25f / k;
+}
+
+
+// ---- SCENES --------------------------------------
+// everything that depends on iTime only is worked out once per tile
+
+struct PointLight {
+    vec3 position;
+    float intensity;
+};
+
+struct RaymarchScene {
+    vec3 centre1, centre2;
+    PointLight light{vec3(0.0f, 15.0f, 15.0f), 30000.0f};
+
+    explicit RaymarchScene(float time)
+        : centre1(std::sin(time / 2.0f) * 5.0f, 0.0f, 40.0f),
+          centre2(std::sin(time / 2.0f) * 5.0f + std::sin(time / 0.5f) * 5.0f, 4.5f, 40.0f + std::cos(time / 0.5f) * 4.0f) {}
+
+    template <typename F> F funcImp(tvec3<F> p) const {
+        F f1 = funcSphere(p, centre1, 5.0f);
+        F f2 = funcSphere(p, centre2, 2.5f);
+        return min(f1, f2);
+    }
+
+    template <typename F> tvec3<F> color(tvec3<F> n, F c) const { return c * abs(n.zxy()); }
+};
+
+struct CoolRaymarchScene {
+    PointLight light{vec3(0.0f, -5.0f, 0.0f), 25000.0f};
+    mat3 obj1Spin, obj3Spin, obj4Spin;
+    mat3 cylinderZ = prismRotation(vec3(0.0f, 0.0f, PI / 2.0f));
+    mat3 cylinderX = prismRotation(vec3(PI / 2.0f, 0.0f, 0.0f));
+    mat3 obj2Box = boxRotation(vec3(PI / 4.0f, PI / 4.0f, 0.0f));
+    mat3 frames[5];
+    float obj2SphereY;
+
+    explicit CoolRaymarchScene(float time)
+        : obj1Spin(rotateY(time)), obj3Spin(rotateX(time) * rotateY(PI / 3.0f)), obj4Spin(rotateY(PI / 7.0f)),
+          obj2SphereY(std::sin(time) * 4.5f) {
+        for (int i = 0; i < 5; i++) frames[i] = boxRotation(vec3(0.0f, 0.0f, PI / 20.0f * (float)(5 - i) * std::sin(time / 1.5f)));
+    }
+
+    template <typename F> F funcObj(tvec3<F> p) const {
+        const float h = 2.0f, r = 1.0f;
+        const vec3 pos(-5.0f, 5.0f, 20.0f);
+        p = obj1Spin * (p - pos) + pos;                             // spinning the object
+
+        F c1 = funcCylinder(p, r, h, pos, mat3());
+        F c2 = funcCylinder(p, r, h, pos, cylinderZ);
+        F c3 = funcCylinder(p, r, h, pos, cylinderX);
+        F obj1 = min(min(c1, c2), c3);
+
+        F s = funcSphere(p, pos, h * 1.2f);
+        F b = funcBox(p, vec3(h * 0.9f), pos, mat3());
+        F obj2 = max(s, b);
+
+        return max(-obj1, obj2);
+    }
+
+    template <typename F> F funcObj2(tvec3<F> p) const {
+        const vec3 pos(6.0f, -6.0f, 25.0f);
+        F s = funcSphere(p, pos + vec3(0.0f, obj2SphereY, 0.0f), 1.0f);
+        F b = funcBox(p, vec3(1.2f), pos, obj2Box);
+        return smoothUnion(s, b, 0.5f);
+    }
+
+    template <typename F> F funcObj3(tvec3<F> p) const {
+        const vec3 pos(-5.0f, -5.0f, 25.0f);
+        p = obj3Spin * (p - pos) + pos;
+
+        F s = funcSphere(p, pos, 4.0f);
+        F s2 = funcSphere(p, pos, 3.5f);
+        F obj1 = smoothSubtraction(s, s2, 0.2f);
+
+        const vec2 hexSize(1.5f, 5.0f);
+        F h = funcHexPrism(p, hexSize, pos, mat3());
+        F h2 = funcHexPrism(p, hexSize, pos, cylinderX);
+        F h3 = funcHexPrism(p, hexSize, pos, prismRotation(vec3(0.0f, PI / 2.0f, 0.0f)));
+        F obj2 = smoothUnion(h, smoothUnion(h2, h3, 0.5f), 0.5f);
+
+        return smoothSubtraction(obj2, obj1, 0.4f);
+    }
+
+    template <typename F> F funcObj4(tvec3<F> p) const {
+        const vec3 pos(4.0f, 4.5f, 20.0f);
+        p = obj4Spin * (p - pos) + pos;
+
+        F d = 1.0f;
+        const float e = 0.08f;
+        for (int i = 0; i < 5; i++) {
+            float s = (float)i * 0.5f + 0.8f;
+            F b = funcBoxFrame(p, vec3(s), e, pos, frames[i]);
+            d = smoothUnion(d, b, 0.2f);
+        }
+        return d;
+    }
+
+    template <typename F> F funcImp(tvec3<F> p) const {
+        return min(min(min(funcObj(p), funcObj2(p)), funcObj3(p)), funcObj4(p));
+    }
+
+    template <typename F> tvec3<F> color(tvec3<F> n, F c) const { return tvec3<F>(c * abs(n.xy()), 0.5f); }
+};
+
+
+// ---- MARCHING --------------------------------------
+
+template <typename F> void cameraRay(tvec2<F> p, tvec3<F>& ro, tvec3<F>& rd) {
+    tvec2<F> cp = p / 2.0f - vec2(0.5f, 0.5f);
+    tvec3<F> pix(cp, 0.0f);
+    ro = tvec3<F>(0.0f, 0.0f, -1.0f);
+    rd = normalize(pix - ro);
+}
+
+template <typename F> F calcE(tvec3<F> p, tvec3<F> n, const PointLight& light) {
+    tvec3<F> l = normalize(light.position - p);
+    F r = length(light.position - p);
+    return light.intensity * dot(n, l) / (4.0f * PI * r * r);
+}
+
+template <typename F, typename Scene> tvec3<F> calcNormal(const Scene& scene, tvec3<F> p) {
+    const float eps = 0.001f;
+    const vec2 h(eps, 0.0f);
+    return normalize(tvec3<F>(
+        scene.funcImp(p + h.xyy()) - scene.funcImp(p - h.xyy()),
+        scene.funcImp(p + h.yxy()) - scene.funcImp(p - h.yxy()),
+        scene.funcImp(p + h.yyx()) - scene.funcImp(p - h.yyx())));
+}
+
+// Lanes whose distance is within HIT_EPSILON freeze where they are, and the loop ends once all of them have.
+// Returns the mask of lanes that hit within MAX_STEPS evaluations, like march() per lane
+template <typename F, typename Scene> auto march(const Scene& scene, tvec3<F> ro, tvec3<F> rd, tvec3<F>& p) {
+    p = ro;
+    for (int i = 0;; i++) {
+        F d = scene.funcImp(p);
+        auto hit = abs(d) <= HIT_EPSILON;
+        if (i == MAX_STEPS - 1 || !any(!hit)) return hit;
+        p = select(hit, p, p + rd * d);
+    }
+}
+
+template <typename F, typename Scene> tvec3<F> shade(const Scene& scene, tvec2<F> uv, bool lighting) {
+    tvec3<F> ro, rd, p;
+    cameraRay(uv, ro, rd);
+
+    auto hit = march(scene, ro, rd, p);
+    if (!any(hit)) return tvec3<F>(0.0f);
+
+    tvec3<F> n = calcNormal(scene, p);
+    F c = 1.0f;
+    if (lighting) {
+        float Kd = 1.0f;
+        c = Kd / PI * calcE(p, n, scene.light);                     // lambertian shading
+    }
+    return select(hit, scene.color(n, c), tvec3<F>(0.0f));
+}
+
+// one packet per lanes<F>::count pixels of a row, the last one padded with copies of the row's last pixel
+template <typename F, typename Scene> void marchTile(const Scene& scene, const MarchJob& job, const Tile& tile) {
+    constexpr int N = lanes<F>::count;
+    float u[N], r[N], g[N], b[N];
+
+    for (int row = tile.top; row < tile.bottom; row++) {
+        float v = ((float)(job.height - 1 - row) + 0.5f) / job.height;  // GL counts rows from the bottom
+        uint8_t* pixel = job.image->row(row) + (size_t)tile.left * 4;
+
+        for (int x = tile.left; x < tile.right; x += N) {
+            for (int i = 0; i < N; i++) u[i] = ((float)(x + i < tile.right ? x + i : tile.right - 1) + 0.5f) / job.width;
+            tvec3<F> color = shade(scene, tvec2<F>(load<F>(u), v), job.lighting);
+            store(r, color.x);
+            store(g, color.y);
+            store(b, color.z);
+
+            for (int i = 0; i < N && x + i < tile.right; i++, pixel += 4) {
+                pixel[0] = unorm8(r[i]);
+                pixel[1] = unorm8(g[i]);
+                pixel[2] = unorm8(b[i]);
+                pixel[3] = 255;
+            }
+        }
+    }
+}
+
+template <typename F> void marchTile(const MarchJob& job, const Tile& tile) {
+    if (job.scene == MarchScene::Raymarch) marchTile<F>(RaymarchScene(job.time), job, tile);
+    else marchTile<F>(CoolRaymarchScene(job.time), job, tile);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "cpu_raymarcher.h"
+
+#include "glsl_simd.h"
+#include "cpu_raymarch_kernel.h"
+
+
+namespace cpu {
+
+MarchTileFn scalarMarchKernel() {
+    return &marchTile<float>;
+}
+
+MarchTileFn sseMarchKernel() {
+#if defined(__SSE2__)
+    return &marchTile<glsl::float4>;
+#else
+    return nullptr;
+#endif
+}
+
+static bool cpuSupports(SimdWidth width) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (width == SimdWidth::AVX512) return __builtin_cpu_supports("avx512f");
+    if (width == SimdWidth::AVX2) return __builtin_cpu_supports("avx2");
+    if (width == SimdWidth::SSE) return __builtin_cpu_supports("sse2");
+#endif
+    return width == SimdWidth::Scalar;
+}
+
+MarchTileFn marchKernel(SimdWidth width) {
+    if (!cpuSupports(width)) return nullptr;
+    switch (width) {
+        case SimdWidth::AVX512: return avx512MarchKernel();
+        case SimdWidth::AVX2: return avx2MarchKernel();
+        case SimdWidth::SSE: return sseMarchKernel();
+        default: return scalarMarchKernel();
+    }
+}
+
+SimdWidth bestSimdWidth() {
+    for (SimdWidth width : {SimdWidth::AVX512, SimdWidth::AVX2, SimdWidth::SSE}) {
+        if (marchKernel(width)) return width;
+    }
+    return SimdWidth::Scalar;
+}
+
+const char* simdName(SimdWidth width) {
+    switch (width) {
+        case SimdWidth::AVX512: return "avx512";
+        case SimdWidth::AVX2: return "avx2";
+        case SimdWidth::SSE: return "sse";
+        default: return "scalar";
+    }
+}
+
+bool parseSimdWidth(const std::string& name, SimdWidth& width) {
+    for (SimdWidth w : {SimdWidth::Scalar, SimdWidth::SSE, SimdWidth::AVX2, SimdWidth::AVX512}) {
+        if (name == simdName(w)) {
+            width = w;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseMarchScene(const std::string& shader, MarchScene& scene) {
+    if (shader == "raymarch") scene = MarchScene::Raymarch;
+    else if (shader == "coolRaymarch") scene = MarchScene::CoolRaymarch;
+    else return false;
+    return true;
+}
+
+Image renderRaymarch(MarchScene scene, int width, int height, float time, bool lighting, TileScheduler& scheduler, SimdWidth simd) {
+    MarchTileFn kernel = marchKernel(simd);
+    if (!kernel) kernel = scalarMarchKernel();
+
+    Image image(width, height);
+    MarchJob job{scene, width, height, time, lighting, &image};
+    scheduler.run(width, height, [&](const Tile& tile) { kernel(job, tile); });
+    return image;
+}
+
+}
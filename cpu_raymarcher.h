@@ -0,0 +1,60 @@
+#ifndef CPU_RAYMARCHER_H
+#define CPU_RAYMARCHER_H
+
+#include <string>
+
+#include "image.h"
+#include "tile_scheduler.h"
+
+
+// C++ port of the sphere tracing in shaders/rendering/raymarch.frag and coolRaymarch.frag.
+// Rays are traced in packets of 4 (SSE2), 8 (AVX2) or 16 (AVX-512) lanes, structure-of-arrays, with the SDFs written
+// once as templates over the lane type (see glsl_math.h, glsl_simd.h). Lanes that reach a surface stop moving and the packet stops as soon
+// as every lane has arrived; shading is skipped for packets without a hit.
+// Each instruction set is its own object file built with its own -m flags, the widest one the CPU runs is picked at
+// run time and the scalar kernel is always there as the fallback.
+namespace cpu {
+
+enum class MarchScene {
+    Raymarch,                                                       // raymarch.frag, two spheres
+    CoolRaymarch                                                    // coolRaymarch.frag, CSG objects
+};
+
+enum class SimdWidth {
+    Scalar = 1,
+    SSE = 4,
+    AVX2 = 8,
+    AVX512 = 16
+};
+
+struct MarchJob {
+    MarchScene scene;
+    int width, height;
+    float time;
+    bool lighting;
+    Image* image;                                                   // width x height, rows top to bottom
+};
+
+// renders the pixels of one tile of job.image
+using MarchTileFn = void (*)(const MarchJob& job, const Tile& tile);
+
+MarchTileFn marchKernel(SimdWidth width);                           // null when not built in or not supported by this CPU
+SimdWidth bestSimdWidth();
+const char* simdName(SimdWidth width);
+bool parseSimdWidth(const std::string& name, SimdWidth& width);     // "scalar", "sse", "avx2" or "avx512"
+bool parseMarchScene(const std::string& shader, MarchScene& scene); // rendering shader name -> scene
+
+// whole image, tile by tile on the scheduler's workers, falls back to scalar when `simd` is unavailable
+Image renderRaymarch(MarchScene scene, int width, int height, float time, bool lighting, TileScheduler& scheduler,
+                     SimdWidth simd = bestSimdWidth());
+
+// per instruction set kernels, null when the compiler flags left them out; scalar and SSE2 (part of every x86-64
+// build) live in cpu_raymarcher.cpp, the others in cpu_raymarcher_<isa>.cpp
+MarchTileFn scalarMarchKernel();
+MarchTileFn sseMarchKernel();
+MarchTileFn avx2MarchKernel();
+MarchTileFn avx512MarchKernel();
+
+}
+
+#endif
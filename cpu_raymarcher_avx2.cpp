@@ -0,0 +1,19 @@
+// AVX2 kernel of cpu_raymarcher.h, 8 rays per packet. Built with -mavx2 (see the Makefile), without it this is a stub.
+#include "cpu_raymarcher.h"
+
+#if defined(__AVX2__)
+
+#include "glsl_simd.h"
+#include "cpu_raymarch_kernel.h"
+
+cpu::MarchTileFn cpu::avx2MarchKernel() {
+    return &marchTile<glsl::float8>;
+}
+
+#else
+
+cpu::MarchTileFn cpu::avx2MarchKernel() {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,19 @@
+// AVX-512 kernel of cpu_raymarcher.h, 16 rays per packet. Built with -mavx512f (see the Makefile), without it this is a stub.
+#include "cpu_raymarcher.h"
+
+#if defined(__AVX512F__)
+
+#include "glsl_simd.h"
+#include "cpu_raymarch_kernel.h"
+
+cpu::MarchTileFn cpu::avx512MarchKernel() {
+    return &marchTile<glsl::float16>;
+}
+
+#else
+
+cpu::MarchTileFn cpu::avx512MarchKernel() {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include "cpu_raytracer.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace glsl;
+
+
+namespace cpu {
+
+constexpr float SHADOW_EPSILON = 0.001f;                             // as in raytrace.frag
+
+RaytraceScene::RaytraceScene(const SphereScene& spheres) {
+    for (const SceneSphere& s : spheres.spheres) balls.push_back({vec3(s.center[0], s.center[1], s.center[2]), s.radius});
+    for (const SceneLight& l : spheres.lights) lights.push_back({vec3(l.position[0], l.position[1], l.position[2]), l.intensity});
+}
+
+bool intersect(vec3 ro, vec3 rd, vec3 center, float r, vec3& p) {
+    float a = dot(rd, rd);
+    float b = 2.0f * dot(rd, ro - center);
+    float c = dot(ro - center, ro - center) - r * r;
+
+    float discriminant = b * b - 4.0f * a * c;
+    if (discriminant > 0.0f) {
+        float t1 = (-b - std::sqrt(discriminant)) / (2.0f * a);
+        float t2 = (-b + std::sqrt(discriminant)) / (2.0f * a);
+
+        if (t1 > 0.0f && t2 > 0.0f) {
+            p = ro + std::min(t1, t2) * rd;
+            return true;
+        } else if (t1 > 0.0f) {
+            p = ro + t1 * rd;
+            return true;
+        } else if (t2 > 0.0f) {
+            p = ro + t2 * rd;
+            return true;
+        }
+    }
+    return false;
+}
+
+float calcE(vec3 p, vec3 n, const Light& light) {
+    vec3 l = normalize(light.position - p);
+    float r = length(light.position - p);
+    return light.intensity * dot(n, l) / (4.0f * PI * r * r);
+}
+
+bool underShadow(vec3 p, const Light& light, const std::vector<Ball>& balls) {
+    vec3 rd = normalize(light.position - p);
+    vec3 ro = p + rd * SHADOW_EPSILON;                              // offset to avoid self-intersection
+    float tmax = length(light.position - p);                        // max dist to check (past light source)
+    vec3 hit;
+
+    for (const Ball& ball : balls) {
+        if (intersect(ro, rd, ball.center, ball.radius, hit) && length(hit - ro) < tmax) return true;
+    }
+    return false;
+}
+
+void cameraRay(vec2 p, vec3& ro, vec3& rd) {
+    vec2 cp = p / 2.0f - vec2(0.5f, 0.5f);
+    vec3 pix = vec3(cp, 0.0f);
+    ro = vec3(0.0f, 0.0f, -1.0f);
+    rd = normalize(pix - ro);
+}
+
+vec3 raytrace(vec2 uv, const RaytraceScene& scene, bool lighting) {
+    vec3 ro, rd;
+    cameraRay(uv, ro, rd);
+
+    vec3 firstHit(-1.0f);
+    vec3 normal;
+    for (const Ball& ball : scene.balls) {                          // closest sphere
+        vec3 p;
+        if (intersect(ro, rd, ball.center, ball.radius, p)) {
+            if (firstHit.z < 0.0f || length(p - ro) < length(firstHit - ro)) {
+                firstHit = p;
+                normal = (p - ball.center) / ball.radius;
+            }
+        }
+    }
+    if (firstHit.z < 0.0f) return vec3(0.0f);
+
+    float c = 1.0f;
+    if (lighting) {
+        float Kd = 1.0f;
+        c = 0.0f;
+        for (const Light& light : scene.lights) {
+            float e = Kd / PI * calcE(firstHit, normal, light);     // lambertian shading
+            if (underShadow(firstHit, light, scene.balls)) e = std::min(e, 0.1f);
+            c += e;
+        }
+    }
+    return c * abs(normal);
+}
+
+Image renderRaytrace(const SphereScene& spheres, int width, int height, bool lighting, TileScheduler& scheduler) {
+    Image image(width, height);
+    RaytraceScene scene(spheres);
+
+    scheduler.run(width, height, [&](const Tile& tile) {
+        for (int row = tile.top; row < tile.bottom; row++) {
+            float y = (float)(height - 1 - row) + 0.5f;             // GL counts rows from the bottom
+            uint8_t* pixel = image.row(row) + (size_t)tile.left * 4;
+            for (int x = tile.left; x < tile.right; x++, pixel += 4) {
+                vec3 color = raytrace(vec2(((float)x + 0.5f) / width, y / height), scene, lighting);
+                pixel[0] = unorm8(color.x);
+                pixel[1] = unorm8(color.y);
+                pixel[2] = unorm8(color.z);
+                pixel[3] = 255;
+            }
+        }
+    });
+    return image;
+}
+
+}
@@ -0,0 +1,46 @@
+#ifndef CPU_RAYTRACER_H
+#define CPU_RAYTRACER_H
+
+#include <vector>
+
+#include "glsl_math.h"
+#include "image.h"
+#include "sphere_scene.h"
+#include "tile_scheduler.h"
+
+
+// C++ port of shaders/rendering/raytrace.frag: golden reference for the GPU output and a renderer for machines without one.
+// Follows the shader line by line in float, so results match the GPU to within rounding (a unorm8 step at most, almost everywhere).
+namespace cpu {
+
+struct Ball {
+    glsl::vec3 center;
+    float radius;
+};
+
+struct Light {
+    glsl::vec3 position;
+    float intensity;
+};
+
+struct RaytraceScene {
+    std::vector<Ball> balls;
+    std::vector<Light> lights;
+
+    explicit RaytraceScene(const SphereScene& spheres);             // what Scene uploads for raytrace.frag
+};
+
+bool intersect(glsl::vec3 ro, glsl::vec3 rd, glsl::vec3 center, float r, glsl::vec3& p);
+float calcE(glsl::vec3 p, glsl::vec3 n, const Light& light);
+bool underShadow(glsl::vec3 p, const Light& light, const std::vector<Ball>& balls);
+void cameraRay(glsl::vec2 p, glsl::vec3& ro, glsl::vec3& rd);
+
+// colour of one pixel, uv in [0, 1] with y up as in the shader
+glsl::vec3 raytrace(glsl::vec2 uv, const RaytraceScene& scene, bool lighting);
+
+// whole image, tile by tile on the scheduler's workers, rows top to bottom like RenderTarget::read()
+Image renderRaytrace(const SphereScene& spheres, int width, int height, bool lighting, TileScheduler& scheduler);
+
+}
+
+#endif
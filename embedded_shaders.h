@@ -0,0 +1,18 @@
+#ifndef EMBEDDED_SHADERS_H
+#define EMBEDDED_SHADERS_H
+
+#include <cstddef>
+#include <string_view>
+
+
+// A file under shaders/ compiled into the binary by tools/embed_shaders.cpp (see the Makefile)
+struct EmbeddedShader {
+    std::string_view path;                                          // e.g. "shaders/lib/sdf.glsl"
+    std::string_view source;
+};
+
+// sorted by path, defined in the generated build/generated/embedded_shaders.cpp
+extern const EmbeddedShader embeddedShaders[];
+extern const size_t embeddedShaderCount;
+
+#endif
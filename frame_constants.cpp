@@ -0,0 +1,23 @@
+#include "frame_constants.h"
+
+#include "shader.h"
+
+
+FrameConstants::FrameConstants() {
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstantsData), NULL, GL_STREAM_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, UBO);
+
+    Shader::setBlockBinding("FrameConstants", BINDING);
+}
+
+FrameConstants::~FrameConstants() {
+    glDeleteBuffers(1, &UBO);
+}
+
+void FrameConstants::update(const FrameConstantsData& data) {
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstantsData), NULL, GL_STREAM_DRAW);     // orphan, frames in flight keep the old storage
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstantsData), &data);
+}
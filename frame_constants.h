@@ -0,0 +1,34 @@
+#ifndef FRAME_CONSTANTS_H
+#define FRAME_CONSTANTS_H
+
+#include <glad/glad.h>
+#include <cstdint>
+
+
+// CPU mirror of the std140 "FrameConstants" uniform block declared by every rendering shader
+struct FrameConstantsData {
+    float iResolution[2] = {};                                      // offset 0
+    float iTime = 0.0f;                                             // offset 8
+    int32_t iFrame = 0;                                             // offset 12, frame counter for patterns alternating per frame
+    float iJitter[2] = {};                                          // offset 16, subpixel camera offset in pixels, 0 unless accumulating
+    float iTileOffset[2] = {};                                      // offset 24, pixel position of the target within the image (tiled rendering)
+};
+static_assert(sizeof(FrameConstantsData) == 32, "must match the std140 layout of FrameConstants");
+
+
+// Uniform buffer written once per frame and bound at a fixed binding point for all programs
+class FrameConstants {
+    unsigned int UBO = 0;
+
+public:
+    static const unsigned int BINDING = 0;
+
+    FrameConstants();
+    ~FrameConstants();
+    FrameConstants(const FrameConstants&) = delete;
+    FrameConstants& operator=(const FrameConstants&) = delete;
+
+    void update(const FrameConstantsData& data);                    // orphans the previous frame's storage, never waits on the GPU
+};
+
+#endif
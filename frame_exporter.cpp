@@ -0,0 +1,165 @@
+#include "frame_exporter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include "render_target.h"
+
+
+namespace {
+    const size_t MAX_QUEUED = 4;                                    // encoded frames waiting, bounds memory when encoding is slower than rendering
+
+    uint8_t clampByte(float v) {
+        return (uint8_t)std::clamp(v + 0.5f, 0.0f, 255.0f);
+    }
+}
+
+
+FrameExporter::FrameExporter(const std::string& path, ExportFormat format, int width, int height, int fps, int ringSize)
+    : w(width), h(height), format(format), path(path), slots(std::max(ringSize, 1)) {
+    if (format == ExportFormat::Y4M) {
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty()) std::filesystem::create_directories(parent);
+        stream.open(path, std::ios::binary);
+        stream << "YUV4MPEG2 W" << w << " H" << h << " F" << fps << ":1 Ip A1:1 C444\n";
+    } else {
+        std::filesystem::create_directories(path);
+    }
+
+    for (Slot& slot : slots) {
+        glGenBuffers(1, &slot.PBO);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)w * h * 4, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    encoder = std::thread(&FrameExporter::encode, this);
+}
+
+FrameExporter::~FrameExporter() {
+    finish();
+    for (Slot& slot : slots) glDeleteBuffers(1, &slot.PBO);
+}
+
+void FrameExporter::capture(const RenderTarget& target) {
+    if (target.width() != w || target.height() != h) {
+        std::cout << "ERROR::FRAME_EXPORTER::SIZE_MISMATCH " << target.width() << "x" << target.height() << std::endl;
+        return;
+    }
+
+    // take whatever is already done, then make room for this frame; a slow frame can outlast one wait, and the slot
+    // must not be reused while its fence is live
+    while (retired < captured && retire(false)) {}
+    while (captured - retired == slots.size() && !retire(true)) {}
+
+    Slot& slot = slots[captured % slots.size()];
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target.framebuffer());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, NULL);     // into the PBO, returns without waiting
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = captured++;
+}
+
+bool FrameExporter::retire(bool block) {
+    Slot& slot = slots[retired % slots.size()];
+    GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, block ? 5000000000ull : 0);
+    if (result == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+
+    Frame frame{slot.frame, Image(w, h)};
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.PBO);
+    const uint8_t* data = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)w * h * 4, GL_MAP_READ_BIT);
+    if (data) {
+        for (int y = 0; y < h; y++) memcpy(frame.image.row(h - 1 - y), data + (size_t)y * w * 4, (size_t)w * 4);   // GL rows start at the bottom
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        std::cout << "ERROR::FRAME_EXPORTER::MAP_FAILED frame " << slot.frame << std::endl;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    retired++;
+
+    // back-pressure: wait for the encoder instead of queueing frames without bound
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait(lock, [this] { return queue.size() < MAX_QUEUED; });
+    queue.push_back(std::move(frame));
+    wake.notify_all();
+    return true;
+}
+
+size_t FrameExporter::finish() {
+    while (retired < captured) retire(true);
+
+    if (encoder.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        encoder.join();
+    }
+    if (stream.is_open()) stream.close();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return failures;
+}
+
+void FrameExporter::encode() {
+    while (true) {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        wake.notify_all();                                          // room in the queue
+
+        bool ok = write(frame);
+        if (!ok) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failures++;
+        }
+    }
+}
+
+bool FrameExporter::write(const Frame& frame) {
+    if (format == ExportFormat::Y4M) {
+        // full frame as three planes, BT.601 studio range
+        std::vector<uint8_t> planes((size_t)w * h * 3);
+        uint8_t* Y = planes.data();
+        uint8_t* U = Y + (size_t)w * h;
+        uint8_t* V = U + (size_t)w * h;
+        for (size_t i = 0; i < (size_t)w * h; i++) {
+            float r = frame.image.pixels[i * 4 + 0], g = frame.image.pixels[i * 4 + 1], b = frame.image.pixels[i * 4 + 2];
+            Y[i] = clampByte(16.0f + 0.2568f * r + 0.5041f * g + 0.0979f * b);
+            U[i] = clampByte(128.0f - 0.1482f * r - 0.2910f * g + 0.4392f * b);
+            V[i] = clampByte(128.0f + 0.4392f * r - 0.3678f * g - 0.0714f * b);
+        }
+        stream << "FRAME\n";
+        stream.write((const char*)planes.data(), planes.size());
+        return (bool)stream;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%05llu.%s", (unsigned long long)frame.index, format == ExportFormat::PNG ? "png" : "ppm");
+    std::string file = (std::filesystem::path(path) / name).string();
+    bool ok = format == ExportFormat::PNG ? writePNG(file, frame.image) : writePPM(file, frame.image);
+    if (!ok) std::cout << "ERROR::FRAME_EXPORTER::FAILED TO WRITE " << file << std::endl;
+    return ok;
+}
+
+bool FrameExporter::parse(const std::string& name, ExportFormat& format) {
+    if (name == "png") format = ExportFormat::PNG;
+    else if (name == "ppm") format = ExportFormat::PPM;
+    else if (name == "y4m") format = ExportFormat::Y4M;
+    else return false;
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef FRAME_EXPORTER_H
+#define FRAME_EXPORTER_H
+
+#include <glad/glad.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "image.h"
+
+class RenderTarget;
+
+
+enum class ExportFormat {
+    PNG,                                                            // <dir>/frame_00000.png ...
+    PPM,                                                            // <dir>/frame_00000.ppm ...
+    Y4M                                                             // one YUV4MPEG2 stream (4:4:4, BT.601), readable by ffmpeg
+};
+
+
+// Captures frames without stalling the GPU: glReadPixels goes into a ring of pixel pack buffers and each buffer
+// is mapped only once its fence has signalled, a few frames later. Mapped frames are handed to an encoder thread
+// through a short queue, capture() blocks only when both the ring and the queue are full.
+class FrameExporter {
+    struct Slot {
+        unsigned int PBO = 0;
+        GLsync fence = 0;
+        uint64_t frame = 0;
+    };
+
+    struct Frame {
+        uint64_t index;
+        Image image;
+    };
+
+    int w, h;
+    ExportFormat format;
+    std::string path;
+    std::ofstream stream;                                           // Y4M only
+
+    std::vector<Slot> slots;
+    uint64_t captured = 0, retired = 0;                             // slots[n % size] holds frame n for retired <= n < captured
+
+    std::thread encoder;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Frame> queue;
+    bool stopping = false;
+    size_t failures = 0;                                            // encoder side, guarded by mutex
+
+    bool retire(bool block);                                        // maps the oldest slot if its fence signalled (or waits for it)
+    void encode();                                                  // encoder thread
+    bool write(const Frame& frame);
+
+public:
+    // `path` is a directory for PNG/PPM sequences and a file for Y4M; fps is only recorded in the Y4M header
+    FrameExporter(const std::string& path, ExportFormat format, int width, int height, int fps = 30, int ringSize = 3);
+    ~FrameExporter();                                               // calls finish()
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    void capture(const RenderTarget& target);                       // same size as the exporter
+    size_t finish();                                                // flushes every frame, returns the number of frames that failed to write
+
+    static bool parse(const std::string& name, ExportFormat& format);   // "png", "ppm" or "y4m"
+};
+
+#endif
@@ -0,0 +1,115 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+
+namespace {
+    const size_t HISTORY = 600;
+
+    float ms(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<float, std::milli>(d).count();
+    }
+}
+
+
+FramePacer::FramePacer(PacingMode mode, double targetFps)
+    : current(mode),
+      period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(targetFps, 1.0)))),
+      intervals(HISTORY, 0.0f) {}
+
+void FramePacer::setMode(PacingMode mode) {
+    current = mode;
+    recorded = 0;
+    reset();
+}
+
+double FramePacer::targetFps() const {
+    return 1.0 / std::chrono::duration<double>(period).count();
+}
+
+void FramePacer::wait() {
+    if (current != PacingMode::Limited) return;
+
+    // resync after a stall instead of rushing frames out to catch up
+    Clock::time_point now = Clock::now();
+    deadline += period;
+    if (deadline < now - period) deadline = now;
+
+    // sleep while far from the deadline, learning how much the OS oversleeps
+    while (deadline - Clock::now() > spinMargin) {
+        Clock::duration request = deadline - Clock::now() - spinMargin;
+        Clock::time_point before = Clock::now();
+        std::this_thread::sleep_for(request);
+        Clock::duration over = (Clock::now() - before) - request;
+        spinMargin = std::clamp((spinMargin * 7 + over * 2) / 8, Clock::duration(std::chrono::microseconds(200)),
+                                Clock::duration(std::chrono::milliseconds(4)));
+    }
+
+    // spin the last stretch
+    while (Clock::now() < deadline) std::this_thread::yield();
+}
+
+void FramePacer::presented() {
+    Clock::time_point now = Clock::now();
+    if (hasLast) intervals[recorded++ % HISTORY] = ms(now - lastPresent);
+    lastPresent = now;
+    hasLast = true;
+}
+
+void FramePacer::reset() {
+    hasLast = false;
+    deadline = Clock::now();
+}
+
+PacingJitter FramePacer::jitter() const {
+    PacingJitter j;
+    size_t n = std::min(recorded, HISTORY);
+    if (n == 0) return j;
+
+    for (size_t i = 0; i < n; i++) j.mean += intervals[i];
+    j.mean /= n;
+
+    std::vector<float> deviation(n);
+    for (size_t i = 0; i < n; i++) {
+        deviation[i] = std::abs(intervals[i] - j.mean);
+        j.stddev += deviation[i] * deviation[i];
+    }
+    j.stddev = std::sqrt(j.stddev / n);
+
+    std::sort(deviation.begin(), deviation.end());
+    j.p99 = deviation[std::min(n - 1, (size_t)(0.99f * (n - 1) + 0.5f))];
+    return j;
+}
+
+std::string FramePacer::summary() const {
+    PacingJitter j = jitter();
+    char text[128];
+    if (current == PacingMode::Limited) {
+        snprintf(text, sizeof(text), "limit %.0f fps | %.2f +- %.2f ms, p99 %.2f ms", targetFps(), j.mean, j.stddev, j.p99);
+    } else {
+        snprintf(text, sizeof(text), "%s | %.2f +- %.2f ms, p99 %.2f ms", name(current), j.mean, j.stddev, j.p99);
+    }
+    return text;
+}
+
+const char* FramePacer::name(PacingMode mode) {
+    switch (mode) {
+        case PacingMode::VSync: return "vsync";
+        case PacingMode::Uncapped: return "uncapped";
+        case PacingMode::Limited: return "limit";
+    }
+    return "";
+}
+
+bool FramePacer::parse(const std::string& name, PacingMode& mode) {
+    for (PacingMode m : {PacingMode::VSync, PacingMode::Uncapped, PacingMode::Limited}) {
+        if (name == FramePacer::name(m)) {
+            mode = m;
+            return true;
+        }
+    }
+    return false;
+}
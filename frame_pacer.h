@@ -0,0 +1,58 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+
+enum class PacingMode {
+    VSync,                                                          // swap interval 1, the display paces frames
+    Uncapped,                                                       // swap interval 0, as fast as possible (benchmarking)
+    Limited                                                         // swap interval 0, software limiter at a target rate
+};
+
+struct PacingJitter {
+    float mean = 0.0f;                                              // ms between presented frames
+    float stddev = 0.0f;
+    float p99 = 0.0f;                                               // 99th percentile of |interval - mean|
+};
+
+
+// Frame pacing: the swap interval to use for each mode, a hybrid sleep/spin limiter against the steady clock
+// for PacingMode::Limited, and the jitter of the intervals between presented frames in every mode.
+// The limiter sleeps until shortly before the deadline and spins the rest; the spin margin follows the
+// measured oversleep of the OS, so it stays small where sleeps are precise.
+class FramePacer {
+    using Clock = std::chrono::steady_clock;
+
+    PacingMode current;
+    Clock::duration period;
+    Clock::time_point deadline;
+    Clock::time_point lastPresent;
+    bool hasLast = false;
+    Clock::duration spinMargin = std::chrono::milliseconds(2);
+
+    std::vector<float> intervals;                                   // ring of the last frames, ms
+    size_t recorded = 0;
+
+public:
+    FramePacer(PacingMode mode = PacingMode::VSync, double targetFps = 60.0);
+
+    PacingMode mode() const { return current; }
+    void setMode(PacingMode mode);                                  // also resets the statistics
+    int swapInterval() const { return current == PacingMode::VSync ? 1 : 0; }
+    double targetFps() const;
+
+    void wait();                                                    // call right before swapping, only blocks in Limited mode
+    void presented();                                               // call right after swapping
+    void reset();                                                   // after an idle gap, the next interval is not recorded
+
+    PacingJitter jitter() const;
+    std::string summary() const;                                    // e.g. "limit 60 fps | 16.67 +- 0.04 ms, p99 0.12 ms"
+
+    static const char* name(PacingMode mode);
+    static bool parse(const std::string& name, PacingMode& mode);   // "vsync", "uncapped" or "limit"
+};
+
+#endif
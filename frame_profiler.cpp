@@ -0,0 +1,233 @@
+#include "frame_profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+
+namespace {
+    const char* SECTION_NAMES[] = {"input", "upload", "draw", "swap"};
+
+    float ms(std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<float, std::milli>(d).count();
+    }
+
+    float value(const FrameRecord& r, FrameProfiler::Metric metric) {
+        switch (metric) {
+            case FrameProfiler::Metric::CpuTotal: return r.cpuTotal;
+            case FrameProfiler::Metric::CpuWork: return r.cpuTotal - r.cpu[(int)FrameSection::Swap];
+            case FrameProfiler::Metric::GpuDraw: return r.gpuDraw;
+            default: return r.gpuFrame;
+        }
+    }
+
+    FrameStats percentiles(std::vector<float> values) {
+        FrameStats s;
+        s.samples = values.size();
+        if (values.empty()) return s;
+
+        std::sort(values.begin(), values.end());
+        auto at = [&values](float q) { return values[std::min(values.size() - 1, (size_t)(q * (values.size() - 1) + 0.5f))]; };
+        s.p50 = at(0.50f);
+        s.p95 = at(0.95f);
+        s.p99 = at(0.99f);
+        s.max = values.back();
+        return s;
+    }
+}
+
+
+FrameProfiler::FrameProfiler(size_t capacity, float hitchFactor)
+    : history(capacity), capacity(capacity), hitchFactor(hitchFactor) {
+    medianScratch.reserve(HITCH_WINDOW);
+    for (QuerySlot& slot : slots) {
+        glGenQueries(1, &slot.elapsed);
+        glGenQueries(1, &slot.frameBegin);
+        glGenQueries(1, &slot.frameEnd);
+    }
+}
+
+FrameProfiler::~FrameProfiler() {
+    for (QuerySlot& slot : slots) {
+        glDeleteQueries(1, &slot.elapsed);
+        glDeleteQueries(1, &slot.frameBegin);
+        glDeleteQueries(1, &slot.frameEnd);
+    }
+}
+
+FrameRecord* FrameProfiler::find(uint64_t frame) {
+    if (frame >= frames || frames - frame > capacity) return nullptr;
+    return &history[frame % capacity];
+}
+
+// Read back a slot if the GPU is done with it; results that are still not there when the slot
+// comes around again are dropped rather than waited for
+void FrameProfiler::collect(QuerySlot& slot) {
+    if (!slot.pending) return;
+    slot.pending = false;
+
+    int available = 0;
+    glGetQueryObjectiv(slot.frameEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    FrameRecord* record = find(slot.frame);
+    if (!record) return;
+
+    GLuint64 begin = 0, end = 0, elapsed = 0;
+    glGetQueryObjectui64v(slot.frameBegin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(slot.frameEnd, GL_QUERY_RESULT, &end);
+    record->gpuFrame = (float)(end - begin) / 1.0e6f;
+
+    // a draw can't outlast its frame, some drivers (llvmpipe) report garbage for the very first elapsed query
+    if (slot.hasElapsed) {
+        glGetQueryObjectui64v(slot.elapsed, GL_QUERY_RESULT, &elapsed);
+        if (elapsed > end - begin) return;
+        record->gpuDraw = (float)elapsed / 1.0e6f;
+        lastGpuDraw = record->gpuDraw;
+        gpuSamples++;
+    }
+}
+
+void FrameProfiler::beginFrame() {
+    QuerySlot& slot = slots[frames % QUERY_FRAMES];
+    collect(slot);
+
+    slot.frame = frames;
+    slot.pending = true;
+    slot.hasElapsed = false;
+    glQueryCounter(slot.frameBegin, GL_TIMESTAMP);
+
+    current = FrameRecord();
+    current.index = frames;
+    frameStart = sectionStart = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::endSection(FrameSection section) {
+    auto now = std::chrono::steady_clock::now();
+    current.cpu[(int)section] += ms(now - sectionStart);
+    sectionStart = now;
+}
+
+void FrameProfiler::beginGpu() {
+    glBeginQuery(GL_TIME_ELAPSED, slots[frames % QUERY_FRAMES].elapsed);
+}
+
+void FrameProfiler::endGpu() {
+    glEndQuery(GL_TIME_ELAPSED);
+    slots[frames % QUERY_FRAMES].hasElapsed = true;
+}
+
+void FrameProfiler::endFrame() {
+    glQueryCounter(slots[frames % QUERY_FRAMES].frameEnd, GL_TIMESTAMP);
+    current.cpuTotal = ms(std::chrono::steady_clock::now() - frameStart);
+
+    // compare against the median of what came before, the first frames have nothing to compare to
+    if (frames % HITCH_REFRESH == 0 && frames > 0) updateHitchMedian();
+    if (hitchMedian > 0.0f && current.cpuTotal > hitchFactor * hitchMedian) {
+        current.hitch = true;
+        hitches++;
+    }
+
+    history[frames % capacity] = current;
+    frames++;
+}
+
+// Median CPU time of the newest frames, a partial selection rather than the full sort of stats() so
+// it stays cheap inside the frame being measured
+void FrameProfiler::updateHitchMedian() {
+    size_t count = (size_t)std::min<uint64_t>({frames, capacity, HITCH_WINDOW});
+    medianScratch.clear();
+    for (uint64_t f = frames - count; f < frames; f++) medianScratch.push_back(history[f % capacity].cpuTotal);
+
+    auto middle = medianScratch.begin() + medianScratch.size() / 2;
+    std::nth_element(medianScratch.begin(), middle, medianScratch.end());
+    hitchMedian = *middle;
+}
+
+std::vector<const FrameRecord*> FrameProfiler::recent() const {
+    std::vector<const FrameRecord*> records;
+    uint64_t first = frames > capacity ? frames - capacity : 0;
+    for (uint64_t f = first; f < frames; f++) records.push_back(&history[f % capacity]);
+    return records;
+}
+
+FrameStats FrameProfiler::stats(Metric metric) const {
+    std::vector<float> values;
+    for (const FrameRecord* r : recent()) {
+        float v = value(*r, metric);
+        if (v >= 0.0f) values.push_back(v);
+    }
+    return percentiles(std::move(values));
+}
+
+FrameStats FrameProfiler::stats(FrameSection section) const {
+    std::vector<float> values;
+    for (const FrameRecord* r : recent()) values.push_back(r->cpu[(int)section]);
+    return percentiles(std::move(values));
+}
+
+std::vector<float> FrameProfiler::graph(Metric metric, size_t count) const {
+    std::vector<float> values(count, 0.0f);
+    std::vector<const FrameRecord*> records = recent();
+    size_t n = std::min(count, records.size());
+    for (size_t i = 0; i < n; i++) {
+        const FrameRecord* r = records[records.size() - n + i];
+        float v = value(*r, metric);
+        values[count - n + i] = std::max(v, 0.0f);
+    }
+    return values;
+}
+
+std::string FrameProfiler::summary() const {
+    // the swap section is the CPU blocked on vsync and on the GPU, counting it would call every frame CPU-bound
+    FrameStats cpu = stats(Metric::CpuWork);
+    FrameStats gpu = stats(Metric::GpuDraw);
+
+    char text[256];
+    snprintf(text, sizeof(text), "CPU work p50 %.2f p95 %.2f p99 %.2f ms | GPU draw p50 %.2f p95 %.2f p99 %.2f ms | %s-bound | %zu hitches",
+             cpu.p50, cpu.p95, cpu.p99, gpu.p50, gpu.p95, gpu.p99, gpu.p50 > cpu.p50 ? "GPU" : "CPU", hitches);
+    return text;
+}
+
+bool FrameProfiler::writeCSV(const std::string& path) const {
+    std::ofstream out(path);
+    out << "frame,cpu_total_ms";
+    for (const char* name : SECTION_NAMES) out << ",cpu_" << name << "_ms";
+    out << ",gpu_draw_ms,gpu_frame_ms,hitch\n";
+
+    for (const FrameRecord* r : recent()) {
+        out << r->index << "," << r->cpuTotal;
+        for (float v : r->cpu) out << "," << v;
+        out << "," << r->gpuDraw << "," << r->gpuFrame << "," << (r->hitch ? 1 : 0) << "\n";
+    }
+    return (bool)out;
+}
+
+bool FrameProfiler::writeJSON(const std::string& path) const {
+    auto entry = [](std::ofstream& out, const char* name, const FrameStats& s, bool last) {
+        out << "    \"" << name << "\": {\"p50\": " << s.p50 << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99
+            << ", \"max\": " << s.max << ", \"samples\": " << s.samples << "}" << (last ? "\n" : ",\n");
+    };
+
+    std::ofstream out(path);
+    out << "{\n  \"frames\": " << frames << ",\n  \"hitches\": " << hitches << ",\n  \"ms\": {\n";
+    entry(out, "cpu_total", stats(Metric::CpuTotal), false);
+    entry(out, "cpu_work", stats(Metric::CpuWork), false);
+    for (int s = 0; s < (int)FrameSection::Count; s++) {
+        std::string name = std::string("cpu_") + SECTION_NAMES[s];
+        entry(out, name.c_str(), stats((FrameSection)s), false);
+    }
+    entry(out, "gpu_draw", stats(Metric::GpuDraw), false);
+    entry(out, "gpu_frame", stats(Metric::GpuFrame), true);
+    out << "  }\n}\n";
+    return (bool)out;
+}
+
+bool FrameProfiler::write(const std::string& path) const {
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    bool ok = json ? writeJSON(path) : writeCSV(path);
+    if (ok) std::cout << "Wrote frame timings to " << path << std::endl;
+    else std::cout << "ERROR::FRAME_PROFILER::FAILED TO WRITE " << path << std::endl;
+    return ok;
+}
@@ -0,0 +1,101 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// CPU phases of a frame, timed back to back between beginFrame() and endFrame()
+enum class FrameSection {
+    Input,
+    Upload,                                                         // uniform/buffer updates
+    Draw,                                                           // issuing draw calls
+    Swap,                                                           // buffer swap and event polling
+    Count
+};
+
+struct FrameRecord {
+    uint64_t index = 0;
+    float cpu[(int)FrameSection::Count] = {};                       // ms per section
+    float cpuTotal = 0.0f;                                          // ms from beginFrame() to endFrame()
+    float gpuDraw = -1.0f;                                          // ms of GPU work between beginGpu()/endGpu(), -1 until known
+    float gpuFrame = -1.0f;                                         // ms between the GPU timestamps at frame start and end
+    bool hitch = false;
+};
+
+struct FrameStats {
+    float p50 = 0.0f, p95 = 0.0f, p99 = 0.0f, max = 0.0f;
+    size_t samples = 0;
+};
+
+
+// Per-frame CPU section timings plus GPU timer queries, kept for the last `capacity` frames.
+// GPU queries live in a small ring and are only read back once available, a few frames later,
+// so profiling never stalls the pipeline.
+class FrameProfiler {
+    static const int QUERY_FRAMES = 4;                              // frames in flight before a query slot is reused
+    static const size_t HITCH_WINDOW = 256;                         // frames the hitch median is taken over
+    static const uint64_t HITCH_REFRESH = 32;                       // frames between median updates, also the first one
+
+    struct QuerySlot {
+        unsigned int elapsed = 0, frameBegin = 0, frameEnd = 0;
+        uint64_t frame = 0;
+        bool pending = false;
+        bool hasElapsed = false;
+    };
+
+    std::vector<FrameRecord> history;                               // ring indexed by frame % capacity
+    size_t capacity;
+    uint64_t frames = 0;                                            // frames completed
+    size_t hitches = 0;
+    float hitchFactor;
+    float hitchMedian = 0.0f;                                       // CPU ms, 0 until the first refresh
+    std::vector<float> medianScratch;                               // reused by updateHitchMedian(), never reallocates
+    uint64_t gpuSamples = 0;                                        // GPU draw results read back so far
+    float lastGpuDraw = -1.0f;
+
+    QuerySlot slots[QUERY_FRAMES];
+    FrameRecord current;
+    std::chrono::steady_clock::time_point frameStart, sectionStart;
+
+    void collect(QuerySlot& slot);
+    void updateHitchMedian();
+    FrameRecord* find(uint64_t frame);
+    std::vector<const FrameRecord*> recent() const;
+
+public:
+    // a frame is a hitch when its CPU time exceeds hitchFactor x the median of the last HITCH_WINDOW frames
+    FrameProfiler(size_t capacity = 4096, float hitchFactor = 2.0f);
+    ~FrameProfiler();
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+    void beginFrame();
+    void endSection(FrameSection section);                          // time since the previous mark is charged to `section`
+    void beginGpu();                                                // GL_TIME_ELAPSED around the frame's GPU work, no nesting
+    void endGpu();
+    void endFrame();
+
+    // CpuWork is the frame without Swap, where the CPU only waits for vsync and the GPU
+    enum class Metric { CpuTotal, CpuWork, GpuDraw, GpuFrame };
+    FrameStats stats(Metric metric) const;
+    FrameStats stats(FrameSection section) const;
+    size_t hitchCount() const { return hitches; }
+
+    // newest GPU draw time read back, compare gpuDrawSamples() between calls to tell whether it is a new one
+    float latestGpuDraw() const { return lastGpuDraw; }
+    uint64_t gpuDrawSamples() const { return gpuSamples; }
+
+    // last `count` values of a metric, oldest first, 0 where the GPU result never arrived
+    std::vector<float> graph(Metric metric, size_t count) const;
+
+    std::string summary() const;                                    // one line, e.g. for a window title; GPU draw vs CPU work decides the bound
+    bool writeCSV(const std::string& path) const;                   // one row per frame
+    bool writeJSON(const std::string& path) const;                  // percentiles per metric and section
+    bool write(const std::string& path) const;                      // by extension, .json or .csv
+};
+
+#endif
@@ -0,0 +1,31 @@
+#include "fullscreen_quad.h"
+
+FullscreenQuad::FullscreenQuad() {
+    float vertices[] = {
+        // positions
+        1.0f, -1.0f, 0.0f,       // bottom right
+        -1.0f, -1.0f, 0.0f,      // bottom left
+        1.0f, 1.0f, 0.0f,        // top right
+        -1.0f, 1.0f, 0.0f,     // top left
+    };
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);                          // generate unique buffer ID for VBO
+    glBindVertexArray(VAO);                         // bind Vertex Array Object
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);             // bind buffer to `GL_ARRAY_BUFFER` target
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);                      // copies vertex data to currently bound buffer (VBO)
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);                   // set vertex attribute pointers
+    glEnableVertexAttribArray(0);
+}
+
+FullscreenQuad::~FullscreenQuad() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+}
+
+void FullscreenQuad::draw() const {
+    // draw triangles
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
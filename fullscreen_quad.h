@@ -0,0 +1,20 @@
+#ifndef FULLSCREEN_QUAD_H
+#define FULLSCREEN_QUAD_H
+
+#include <glad/glad.h>
+
+
+// Two triangles covering clip space, every rendering shader is a full-screen fragment program
+class FullscreenQuad {
+    unsigned int VBO = 0, VAO = 0;
+
+public:
+    FullscreenQuad();
+    ~FullscreenQuad();
+    FullscreenQuad(const FullscreenQuad&) = delete;
+    FullscreenQuad& operator=(const FullscreenQuad&) = delete;
+
+    void draw() const;
+};
+
+#endif
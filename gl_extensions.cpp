@@ -0,0 +1,44 @@
+#include "gl_extensions.h"
+
+#include <cstring>
+
+int GLAD_GL_ARB_get_program_binary = 0;
+PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARYPROC glad_glProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = NULL;
+
+int GLAD_GL_KHR_parallel_shader_compile = 0;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = NULL;
+
+
+bool hasGLExtension(const char* name) {
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; i++) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (extension && strcmp(extension, name) == 0) return true;
+    }
+    return false;
+}
+
+void loadGLExtensions(GLADloadproc load) {
+    bool gl41 = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1);
+
+    // program binaries are useless if the driver supports no binary formats (e.g. macOS)
+    int binaryFormats = 0;
+    if (gl41 || hasGLExtension("GL_ARB_get_program_binary")) {
+        glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+        glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+        glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+    }
+    GLAD_GL_ARB_get_program_binary = glad_glGetProgramBinary && glad_glProgramBinary && glad_glProgramParameteri && binaryFormats > 0;
+
+    if (hasGLExtension("GL_KHR_parallel_shader_compile")) {
+        glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+    } else if (hasGLExtension("GL_ARB_parallel_shader_compile")) {
+        glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+    }
+    GLAD_GL_KHR_parallel_shader_compile = glad_glMaxShaderCompilerThreadsKHR != NULL;
+    if (GLAD_GL_KHR_parallel_shader_compile) glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);     // let the driver pick the thread count
+}
@@ -0,0 +1,244 @@
+#ifndef GLSL_MATH_H
+#define GLSL_MATH_H
+
+#include <cmath>
+#include <type_traits>
+
+
+// GLSL-style vector math for CPU ports of the shaders, so ported code reads like the GLSL it mirrors.
+// Vectors and matrices are templates on the lane type: float for one ray at a time (tvec3<float> is plain AoS
+// x, y, z), or a SIMD packet from glsl_simd.h (float4, float8, float16) where a tvec3 holds x, y and z of 4 to 16
+// rays in three registers (SoA). Kernels written against these types compile to scalar or packet code unchanged.
+//   - operators are component-wise, vectors mix with scalars and with vectors of another lane type:
+//     `length(p - centre)` works for a packet p and a scalar centre, the result is a packet
+//   - swizzles are member functions: v.xy(), v.zxy(), v.xz()...
+//   - functions: dot, cross, length, distance, normalize, abs, sign, min, max, clamp, mix, select
+//   - comparisons of lanes give bool for float and a lane mask for packets, used with select(mask, a, b) and any()
+//   - matrices are column major, mat3(1.0f) and mat3() are the identity
+// Everything that does not need a square root or the C math library is constexpr.
+//
+// Every translation unit gets its own copy in an inline namespace named after the instruction set it is
+// compiled for, so inline functions built with -mavx512f are never linked into code that runs without it.
+#if defined(__AVX512F__)
+#define GLSL_ISA avx512
+#elif defined(__AVX2__)
+#define GLSL_ISA avx2
+#else
+#define GLSL_ISA generic
+#endif
+
+namespace glsl {
+inline namespace GLSL_ISA {
+
+// ---- LANES --------------------------------------
+
+// number of rays a lane type carries, 0 for anything that is not one
+template <typename T> struct lanes { static constexpr int count = 0; };
+template <> struct lanes<float> { static constexpr int count = 1; };
+
+template <typename T> concept lane = lanes<T>::count > 0;
+template <typename T> using scalar = std::type_identity_t<T>;      // non-deduced, so floats convert to the lane type
+
+// the scalar lane, packets provide the same set
+constexpr float min(float a, float b) { return b < a ? b : a; }
+constexpr float max(float a, float b) { return a < b ? b : a; }
+inline float abs(float a) { return std::fabs(a); }
+inline float sqrt(float a) { return std::sqrt(a); }
+constexpr float sign(float a) { return a > 0.0f ? 1.0f : a < 0.0f ? -1.0f : 0.0f; }
+constexpr float clamp(float a, float lo, float hi) { return min(max(a, lo), hi); }
+constexpr float select(bool mask, float a, float b) { return mask ? a : b; }  // a where mask is set, else b
+constexpr bool any(bool mask) { return mask; }
+
+template <typename T> T load(const float* values) { return *values; }
+inline void store(float* values, float a) { *values = a; }
+
+// a + (b - a) * t for lanes, vectors and any mix of them
+template <typename A, typename B, typename S> constexpr auto mix(A a, B b, S t) { return a + (b - a) * t; }
+
+
+// ---- VECTORS --------------------------------------
+
+#define GLSL_SWIZZLE2(a, b) constexpr tvec2<T> a##b() const { return {a, b}; }
+#define GLSL_SWIZZLE3(a, b, c) constexpr tvec3<T> a##b##c() const { return {a, b, c}; }
+#define GLSL_SWIZZLE3_XY(a, b) GLSL_SWIZZLE3(a, b, x) GLSL_SWIZZLE3(a, b, y)
+#define GLSL_SWIZZLE2_XYZ(a) GLSL_SWIZZLE2(a, x) GLSL_SWIZZLE2(a, y) GLSL_SWIZZLE2(a, z)
+#define GLSL_SWIZZLE3_XYZ(a, b) GLSL_SWIZZLE3(a, b, x) GLSL_SWIZZLE3(a, b, y) GLSL_SWIZZLE3(a, b, z)
+#define GLSL_SWIZZLE2_XYZW(a) GLSL_SWIZZLE2_XYZ(a) GLSL_SWIZZLE2(a, w)
+#define GLSL_SWIZZLE3_XYZW(a, b) GLSL_SWIZZLE3_XYZ(a, b) GLSL_SWIZZLE3(a, b, w)
+
+template <typename T> struct tvec3;
+
+template <typename T>
+struct tvec2 {
+    T x, y;
+
+    constexpr tvec2() : x(0.0f), y(0.0f) {}
+    constexpr explicit tvec2(scalar<T> s) : x(s), y(s) {}
+    constexpr tvec2(scalar<T> x, scalar<T> y) : x(x), y(y) {}
+    template <typename U> constexpr explicit tvec2(tvec2<U> v) : x(v.x), y(v.y) {}    // broadcast a scalar vector
+
+    GLSL_SWIZZLE2(x, x) GLSL_SWIZZLE2(x, y) GLSL_SWIZZLE2(y, x) GLSL_SWIZZLE2(y, y)
+    GLSL_SWIZZLE3_XY(x, x) GLSL_SWIZZLE3_XY(x, y) GLSL_SWIZZLE3_XY(y, x) GLSL_SWIZZLE3_XY(y, y)
+};
+
+template <typename T>
+struct tvec3 {
+    T x, y, z;
+
+    constexpr tvec3() : x(0.0f), y(0.0f), z(0.0f) {}
+    constexpr explicit tvec3(scalar<T> s) : x(s), y(s), z(s) {}
+    constexpr tvec3(scalar<T> x, scalar<T> y, scalar<T> z) : x(x), y(y), z(z) {}
+    constexpr tvec3(tvec2<T> xy, scalar<T> z) : x(xy.x), y(xy.y), z(z) {}
+    constexpr tvec3(scalar<T> x, tvec2<T> yz) : x(x), y(yz.x), z(yz.y) {}
+    template <typename U> constexpr explicit tvec3(tvec3<U> v) : x(v.x), y(v.y), z(v.z) {}
+
+    GLSL_SWIZZLE2_XYZ(x) GLSL_SWIZZLE2_XYZ(y) GLSL_SWIZZLE2_XYZ(z)
+    GLSL_SWIZZLE3_XYZ(x, x) GLSL_SWIZZLE3_XYZ(x, y) GLSL_SWIZZLE3_XYZ(x, z)
+    GLSL_SWIZZLE3_XYZ(y, x) GLSL_SWIZZLE3_XYZ(y, y) GLSL_SWIZZLE3_XYZ(y, z)
+    GLSL_SWIZZLE3_XYZ(z, x) GLSL_SWIZZLE3_XYZ(z, y) GLSL_SWIZZLE3_XYZ(z, z)
+};
+
+template <typename T>
+struct tvec4 {
+    T x, y, z, w;
+
+    constexpr tvec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+    constexpr explicit tvec4(scalar<T> s) : x(s), y(s), z(s), w(s) {}
+    constexpr tvec4(scalar<T> x, scalar<T> y, scalar<T> z, scalar<T> w) : x(x), y(y), z(z), w(w) {}
+    constexpr tvec4(tvec3<T> xyz, scalar<T> w) : x(xyz.x), y(xyz.y), z(xyz.z), w(w) {}
+    constexpr tvec4(tvec2<T> xy, tvec2<T> zw) : x(xy.x), y(xy.y), z(zw.x), w(zw.y) {}
+    template <typename U> constexpr explicit tvec4(tvec4<U> v) : x(v.x), y(v.y), z(v.z), w(v.w) {}
+
+    GLSL_SWIZZLE2_XYZW(x) GLSL_SWIZZLE2_XYZW(y) GLSL_SWIZZLE2_XYZW(z) GLSL_SWIZZLE2_XYZW(w)
+    GLSL_SWIZZLE3_XYZW(x, x) GLSL_SWIZZLE3_XYZW(x, y) GLSL_SWIZZLE3_XYZW(x, z) GLSL_SWIZZLE3_XYZW(x, w)
+    GLSL_SWIZZLE3_XYZW(y, x) GLSL_SWIZZLE3_XYZW(y, y) GLSL_SWIZZLE3_XYZW(y, z) GLSL_SWIZZLE3_XYZW(y, w)
+    GLSL_SWIZZLE3_XYZW(z, x) GLSL_SWIZZLE3_XYZW(z, y) GLSL_SWIZZLE3_XYZW(z, z) GLSL_SWIZZLE3_XYZW(z, w)
+    GLSL_SWIZZLE3_XYZW(w, x) GLSL_SWIZZLE3_XYZW(w, y) GLSL_SWIZZLE3_XYZW(w, z) GLSL_SWIZZLE3_XYZW(w, w)
+    constexpr tvec4<T> xyzw() const { return *this; }
+};
+
+#undef GLSL_SWIZZLE2
+#undef GLSL_SWIZZLE3
+#undef GLSL_SWIZZLE3_XY
+#undef GLSL_SWIZZLE2_XYZ
+#undef GLSL_SWIZZLE3_XYZ
+#undef GLSL_SWIZZLE2_XYZW
+#undef GLSL_SWIZZLE3_XYZW
+
+// applies f to every component, the result's lane type is whatever f returns
+template <typename A, typename F> constexpr auto map(tvec2<A> a, F f) { return tvec2<decltype(f(a.x))>(f(a.x), f(a.y)); }
+template <typename A, typename F> constexpr auto map(tvec3<A> a, F f) { return tvec3<decltype(f(a.x))>(f(a.x), f(a.y), f(a.z)); }
+template <typename A, typename F> constexpr auto map(tvec4<A> a, F f) { return tvec4<decltype(f(a.x))>(f(a.x), f(a.y), f(a.z), f(a.w)); }
+template <typename A, typename B, typename F> constexpr auto map(tvec2<A> a, tvec2<B> b, F f) {
+    return tvec2<decltype(f(a.x, b.x))>(f(a.x, b.x), f(a.y, b.y));
+}
+template <typename A, typename B, typename F> constexpr auto map(tvec3<A> a, tvec3<B> b, F f) {
+    return tvec3<decltype(f(a.x, b.x))>(f(a.x, b.x), f(a.y, b.y), f(a.z, b.z));
+}
+template <typename A, typename B, typename F> constexpr auto map(tvec4<A> a, tvec4<B> b, F f) {
+    return tvec4<decltype(f(a.x, b.x))>(f(a.x, b.x), f(a.y, b.y), f(a.z, b.z), f(a.w, b.w));
+}
+
+// component-wise operator and function for every vector size: vector op vector, vector op lane, lane op vector
+#define GLSL_COMPONENTWISE(V, name, expr)                                                                           \
+    template <typename A, typename B> constexpr auto name(V<A> a, V<B> b) {                                         \
+        return map(a, b, [](A x, B y) { return expr; });                                                            \
+    }                                                                                                               \
+    template <typename A, lane B> constexpr auto name(V<A> a, B y) { return map(a, [y](A x) { return expr; }); }     \
+    template <lane A, typename B> constexpr auto name(A x, V<B> b) { return map(b, [x](B y) { return expr; }); }
+#define GLSL_VECTOR_OPERATORS(V)                                                                                    \
+    GLSL_COMPONENTWISE(V, operator+, x + y)                                                                         \
+    GLSL_COMPONENTWISE(V, operator-, x - y)                                                                         \
+    GLSL_COMPONENTWISE(V, operator*, x * y)                                                                         \
+    GLSL_COMPONENTWISE(V, operator/, x / y)                                                                         \
+    GLSL_COMPONENTWISE(V, min, min(x, y))                                                                           \
+    GLSL_COMPONENTWISE(V, max, max(x, y))                                                                           \
+    template <typename T> constexpr V<T> operator-(V<T> a) { return map(a, [](T x) { return -x; }); }              \
+    template <typename T> V<T> abs(V<T> a) { return map(a, [](T x) { return abs(x); }); }                          \
+    template <typename T> constexpr V<T> sign(V<T> a) { return map(a, [](T x) { return sign(x); }); }              \
+    template <typename T, typename B> constexpr V<T>& operator+=(V<T>& a, B b) { return a = a + b; }               \
+    template <typename T, typename B> constexpr V<T>& operator-=(V<T>& a, B b) { return a = a - b; }               \
+    template <typename T, typename B> constexpr V<T>& operator*=(V<T>& a, B b) { return a = a * b; }               \
+    template <typename T, typename B> constexpr V<T>& operator/=(V<T>& a, B b) { return a = a / b; }               \
+    template <typename T, typename L, typename H> constexpr auto clamp(V<T> a, L lo, H hi) { return min(max(a, lo), hi); } \
+    template <typename M, typename T> constexpr V<T> select(M mask, V<T> a, V<T> b) {                              \
+        return map(a, b, [mask](T x, T y) { return select(mask, x, y); });                                          \
+    }
+
+GLSL_VECTOR_OPERATORS(tvec2)
+GLSL_VECTOR_OPERATORS(tvec3)
+GLSL_VECTOR_OPERATORS(tvec4)
+
+#undef GLSL_COMPONENTWISE
+#undef GLSL_VECTOR_OPERATORS
+
+template <typename A, typename B> constexpr auto dot(tvec2<A> a, tvec2<B> b) { return a.x * b.x + a.y * b.y; }
+template <typename A, typename B> constexpr auto dot(tvec3<A> a, tvec3<B> b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+template <typename A, typename B> constexpr auto dot(tvec4<A> a, tvec4<B> b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+template <typename A, typename B> constexpr auto cross(tvec3<A> a, tvec3<B> b) {
+    return tvec3<decltype(a.x * b.x)>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+template <typename V> auto length(V v) { return sqrt(dot(v, v)); }
+template <typename A, typename B> auto distance(A a, B b) { return length(a - b); }
+template <typename V> V normalize(V v) { return v / length(v); }
+
+
+// ---- MATRICES --------------------------------------
+// column major like GLSL; a scalar matrix times a packet vector is a packet, transforms are usually uniform
+
+template <typename T>
+struct tmat3 {
+    tvec3<T> columns[3];
+
+    constexpr explicit tmat3(scalar<T> diagonal = 1.0f)
+        : columns{{diagonal, 0.0f, 0.0f}, {0.0f, diagonal, 0.0f}, {0.0f, 0.0f, diagonal}} {}
+    constexpr tmat3(scalar<T> a, scalar<T> b, scalar<T> c, scalar<T> d, scalar<T> e, scalar<T> f, scalar<T> g, scalar<T> h, scalar<T> i)
+        : columns{{a, b, c}, {d, e, f}, {g, h, i}} {}
+    constexpr tmat3(tvec3<T> c0, tvec3<T> c1, tvec3<T> c2) : columns{c0, c1, c2} {}
+
+    constexpr tvec3<T>& operator[](int column) { return columns[column]; }
+    constexpr const tvec3<T>& operator[](int column) const { return columns[column]; }
+};
+
+template <typename T>
+struct tmat4 {
+    tvec4<T> columns[4];
+
+    constexpr explicit tmat4(scalar<T> diagonal = 1.0f)
+        : columns{{diagonal, 0.0f, 0.0f, 0.0f}, {0.0f, diagonal, 0.0f, 0.0f}, {0.0f, 0.0f, diagonal, 0.0f}, {0.0f, 0.0f, 0.0f, diagonal}} {}
+    constexpr tmat4(tvec4<T> c0, tvec4<T> c1, tvec4<T> c2, tvec4<T> c3) : columns{c0, c1, c2, c3} {}
+
+    constexpr tvec4<T>& operator[](int column) { return columns[column]; }
+    constexpr const tvec4<T>& operator[](int column) const { return columns[column]; }
+};
+
+template <typename M, typename T> constexpr auto operator*(const tmat3<M>& m, tvec3<T> v) {
+    return m[0] * v.x + m[1] * v.y + m[2] * v.z;
+}
+
+template <typename M, typename T> constexpr auto operator*(const tmat4<M>& m, tvec4<T> v) {
+    return m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w;
+}
+
+template <typename T> constexpr tmat3<T> operator*(const tmat3<T>& a, const tmat3<T>& b) { return {a * b[0], a * b[1], a * b[2]}; }
+template <typename T> constexpr tmat4<T> operator*(const tmat4<T>& a, const tmat4<T>& b) { return {a * b[0], a * b[1], a * b[2], a * b[3]}; }
+
+template <typename T> constexpr tmat3<T> transpose(const tmat3<T>& m) {
+    return {m[0].x, m[1].x, m[2].x, m[0].y, m[1].y, m[2].y, m[0].z, m[1].z, m[2].z};
+}
+
+
+using vec2 = tvec2<float>;
+using vec3 = tvec3<float>;
+using vec4 = tvec4<float>;
+using mat3 = tmat3<float>;
+using mat4 = tmat4<float>;
+
+constexpr float PI = 3.1415926535897932384626433832795f;
+
+}
+}
+
+#endif
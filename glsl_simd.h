@@ -0,0 +1,156 @@
+#ifndef GLSL_SIMD_H
+#define GLSL_SIMD_H
+
+#include <immintrin.h>
+
+#include "glsl_math.h"
+
+
+// SIMD lane types for glsl_math.h: one float per ray of a packet, stored structure-of-arrays so a tvec3<float8>
+// is three registers (x, y, z of 8 rays). Comparisons give a lane mask used with select() and any().
+// Only what the compiler flags of the including file allow is defined (SSE2 is part of every x86-64 build),
+// see cpu_raymarcher.h for the dispatch. Results are bit-identical to the float lane: same operations, same order,
+// min/max with the operands of min(float)/max(float) and no fused multiply-add.
+namespace glsl {
+inline namespace GLSL_ISA {
+
+#if defined(__SSE2__)
+
+// ---- SSE2, 4 LANES --------------------------------------
+
+struct mask4 {
+    __m128 m;                                                       // all bits set in lanes where true
+};
+
+inline mask4 operator&(mask4 a, mask4 b) { return {_mm_and_ps(a.m, b.m)}; }
+inline mask4 operator|(mask4 a, mask4 b) { return {_mm_or_ps(a.m, b.m)}; }
+inline mask4 operator!(mask4 a) { return {_mm_xor_ps(a.m, _mm_castsi128_ps(_mm_set1_epi32(-1)))}; }
+inline bool any(mask4 a) { return _mm_movemask_ps(a.m) != 0; }
+
+struct float4 {
+    __m128 v;
+
+    float4() : v(_mm_setzero_ps()) {}
+    float4(float s) : v(_mm_set1_ps(s)) {}
+    explicit float4(__m128 v) : v(v) {}
+};
+
+inline float4 operator+(float4 a, float4 b) { return float4(_mm_add_ps(a.v, b.v)); }
+inline float4 operator-(float4 a, float4 b) { return float4(_mm_sub_ps(a.v, b.v)); }
+inline float4 operator*(float4 a, float4 b) { return float4(_mm_mul_ps(a.v, b.v)); }
+inline float4 operator/(float4 a, float4 b) { return float4(_mm_div_ps(a.v, b.v)); }
+inline float4 operator-(float4 a) { return float4(_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))); }
+inline mask4 operator<(float4 a, float4 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline mask4 operator>(float4 a, float4 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline mask4 operator<=(float4 a, float4 b) { return {_mm_cmple_ps(a.v, b.v)}; }
+
+inline float4 min(float4 a, float4 b) { return float4(_mm_min_ps(b.v, a.v)); }
+inline float4 max(float4 a, float4 b) { return float4(_mm_max_ps(b.v, a.v)); }
+inline float4 abs(float4 a) { return float4(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)); }
+inline float4 sqrt(float4 a) { return float4(_mm_sqrt_ps(a.v)); }
+inline float4 select(mask4 mask, float4 a, float4 b) { return float4(_mm_or_ps(_mm_and_ps(mask.m, a.v), _mm_andnot_ps(mask.m, b.v))); }
+inline float4 sign(float4 a) { return select(a > 0.0f, 1.0f, select(a < 0.0f, -1.0f, 0.0f)); }
+inline float4 clamp(float4 a, float4 lo, float4 hi) { return min(max(a, lo), hi); }
+
+template <> struct lanes<float4> { static constexpr int count = 4; };
+template <> inline float4 load<float4>(const float* values) { return float4(_mm_loadu_ps(values)); }
+inline void store(float* values, float4 a) { _mm_storeu_ps(values, a.v); }
+
+#endif
+
+
+#if defined(__AVX2__)
+
+// ---- AVX2, 8 LANES --------------------------------------
+
+struct mask8 {
+    __m256 m;
+};
+
+inline mask8 operator&(mask8 a, mask8 b) { return {_mm256_and_ps(a.m, b.m)}; }
+inline mask8 operator|(mask8 a, mask8 b) { return {_mm256_or_ps(a.m, b.m)}; }
+inline mask8 operator!(mask8 a) { return {_mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))}; }
+inline bool any(mask8 a) { return _mm256_movemask_ps(a.m) != 0; }
+
+struct float8 {
+    __m256 v;
+
+    float8() : v(_mm256_setzero_ps()) {}
+    float8(float s) : v(_mm256_set1_ps(s)) {}
+    explicit float8(__m256 v) : v(v) {}
+};
+
+inline float8 operator+(float8 a, float8 b) { return float8(_mm256_add_ps(a.v, b.v)); }
+inline float8 operator-(float8 a, float8 b) { return float8(_mm256_sub_ps(a.v, b.v)); }
+inline float8 operator*(float8 a, float8 b) { return float8(_mm256_mul_ps(a.v, b.v)); }
+inline float8 operator/(float8 a, float8 b) { return float8(_mm256_div_ps(a.v, b.v)); }
+inline float8 operator-(float8 a) { return float8(_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))); }
+inline mask8 operator<(float8 a, float8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline mask8 operator>(float8 a, float8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+inline mask8 operator<=(float8 a, float8 b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ)}; }
+
+inline float8 min(float8 a, float8 b) { return float8(_mm256_min_ps(b.v, a.v)); }
+inline float8 max(float8 a, float8 b) { return float8(_mm256_max_ps(b.v, a.v)); }
+inline float8 abs(float8 a) { return float8(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)); }
+inline float8 sqrt(float8 a) { return float8(_mm256_sqrt_ps(a.v)); }
+inline float8 select(mask8 mask, float8 a, float8 b) { return float8(_mm256_blendv_ps(b.v, a.v, mask.m)); }
+inline float8 sign(float8 a) { return select(a > 0.0f, 1.0f, select(a < 0.0f, -1.0f, 0.0f)); }
+inline float8 clamp(float8 a, float8 lo, float8 hi) { return min(max(a, lo), hi); }
+
+template <> struct lanes<float8> { static constexpr int count = 8; };
+template <> inline float8 load<float8>(const float* values) { return float8(_mm256_loadu_ps(values)); }
+inline void store(float* values, float8 a) { _mm256_storeu_ps(values, a.v); }
+
+#endif
+
+
+#if defined(__AVX512F__)
+
+// ---- AVX-512, 16 LANES --------------------------------------
+
+struct mask16 {
+    __mmask16 m;
+};
+
+inline mask16 operator&(mask16 a, mask16 b) { return {(__mmask16)(a.m & b.m)}; }
+inline mask16 operator|(mask16 a, mask16 b) { return {(__mmask16)(a.m | b.m)}; }
+inline mask16 operator!(mask16 a) { return {(__mmask16)~a.m}; }
+inline bool any(mask16 a) { return a.m != 0; }
+
+struct float16 {
+    __m512 v;
+
+    float16() : v(_mm512_setzero_ps()) {}
+    float16(float s) : v(_mm512_set1_ps(s)) {}
+    explicit float16(__m512 v) : v(v) {}
+};
+
+inline float16 operator+(float16 a, float16 b) { return float16(_mm512_add_ps(a.v, b.v)); }
+inline float16 operator-(float16 a, float16 b) { return float16(_mm512_sub_ps(a.v, b.v)); }
+inline float16 operator*(float16 a, float16 b) { return float16(_mm512_mul_ps(a.v, b.v)); }
+inline float16 operator/(float16 a, float16 b) { return float16(_mm512_div_ps(a.v, b.v)); }
+inline float16 operator-(float16 a) { return float16(_mm512_sub_ps(_mm512_setzero_ps(), a.v)); }
+inline mask16 operator<(float16 a, float16 b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)}; }
+inline mask16 operator>(float16 a, float16 b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ)}; }
+inline mask16 operator<=(float16 a, float16 b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ)}; }
+
+// the maskz forms with every lane set compile to the same instructions, and avoid GCC 12 warning about the
+// _mm512_undefined_ps() inside the plain ones
+inline float16 min(float16 a, float16 b) { return float16(_mm512_maskz_min_ps(0xFFFF, b.v, a.v)); }
+inline float16 max(float16 a, float16 b) { return float16(_mm512_maskz_max_ps(0xFFFF, b.v, a.v)); }
+inline float16 abs(float16 a) { return float16(_mm512_abs_ps(a.v)); }
+inline float16 sqrt(float16 a) { return float16(_mm512_maskz_sqrt_ps(0xFFFF, a.v)); }
+inline float16 select(mask16 mask, float16 a, float16 b) { return float16(_mm512_mask_blend_ps(mask.m, b.v, a.v)); }
+inline float16 sign(float16 a) { return select(a > 0.0f, 1.0f, select(a < 0.0f, -1.0f, 0.0f)); }
+inline float16 clamp(float16 a, float16 lo, float16 hi) { return min(max(a, lo), hi); }
+
+template <> struct lanes<float16> { static constexpr int count = 16; };
+template <> inline float16 load<float16>(const float* values) { return float16(_mm512_loadu_ps(values)); }
+inline void store(float* values, float16 a) { _mm512_storeu_ps(values, a.v); }
+
+#endif
+
+}
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "headless_context.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <iostream>
+
+#include <glad/glad.h>
+#include "gl_extensions.h"
+
+
+HeadlessContext::HeadlessContext() {
+    // EGL_MESA_platform_surfaceless needs no display server at all
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay dpy = EGL_NO_DISPLAY;
+    if (getPlatformDisplay) dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, NULL, NULL)) {
+        dpy = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, NULL, NULL)) {
+            std::cout << "ERROR::HEADLESS::EGL_INITIALIZE_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+            return;
+        }
+    }
+    display = dpy;
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cout << "ERROR::HEADLESS::OPENGL_API_UNAVAILABLE" << std::endl;
+        return;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config = NULL;
+    EGLint count = 0;
+    if (!eglChooseConfig(dpy, configAttribs, &config, 1, &count) || count == 0) config = NULL;
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext ctx = eglCreateContext(dpy, config ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+    if (ctx == EGL_NO_CONTEXT) {
+        std::cout << "ERROR::HEADLESS::CONTEXT_CREATION_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+        return;
+    }
+
+    // surfaceless first, a tiny pbuffer otherwise (all rendering goes to FBOs anyway)
+    if (!eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx)) {
+        const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        EGLSurface pbuffer = config ? eglCreatePbufferSurface(dpy, config, pbufferAttribs) : EGL_NO_SURFACE;
+        if (pbuffer == EGL_NO_SURFACE || !eglMakeCurrent(dpy, pbuffer, pbuffer, ctx)) {
+            std::cout << "ERROR::HEADLESS::MAKE_CURRENT_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+            eglDestroyContext(dpy, ctx);
+            return;
+        }
+        surface = pbuffer;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(dpy, ctx);
+        return;
+    }
+    loadGLExtensions((GLADloadproc)eglGetProcAddress);
+    context = ctx;
+}
+
+HeadlessContext::~HeadlessContext() {
+    if (!display) return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context) eglDestroyContext(display, context);
+    if (surface) eglDestroySurface(display, surface);
+    eglTerminate(display);
+}
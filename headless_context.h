@@ -0,0 +1,21 @@
+#ifndef HEADLESS_CONTEXT_H
+#define HEADLESS_CONTEXT_H
+
+
+// GL 3.3 core context without a window or display, through EGL (Linux, e.g. Mesa llvmpipe on GPU-less machines).
+// Tries a surfaceless context first and falls back to a 1x1 pbuffer; draw into a RenderTarget.
+class HeadlessContext {
+    void* display = nullptr;                                        // EGLDisplay
+    void* context = nullptr;                                        // EGLContext
+    void* surface = nullptr;                                        // EGLSurface, only for the pbuffer fallback
+
+public:
+    HeadlessContext();                                              // makes the context current and loads GL functions
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    bool valid() const { return context != nullptr; }
+};
+
+#endif
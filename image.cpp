@@ -0,0 +1,122 @@
+#include "image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+
+uint8_t unorm8(float value) {
+    return (uint8_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+}
+
+uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc) {
+    struct Table {
+        uint32_t entries[256];
+        Table() {
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[n] = c;
+            }
+        }
+    };
+    static const Table table;                                       // built once, thread-safe (encoder threads write PNGs too)
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t adler32(const uint8_t* data, size_t length, uint32_t adler) {
+    uint32_t a = adler & 0xFFFF, b = adler >> 16;
+    while (length > 0) {
+        size_t block = length < 5552 ? length : 5552;               // largest run that can't overflow before the modulo
+        length -= block;
+        while (block--) {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+bool writePPM(const std::string& path, const Image& image) {
+    std::ofstream out(path, std::ios::binary);
+    out << "P6\n" << image.width << " " << image.height << "\n255\n";
+
+    std::vector<uint8_t> rgb((size_t)image.width * 3);
+    for (int y = 0; y < image.height; y++) {
+        const uint8_t* src = image.row(y);
+        for (int x = 0; x < image.width; x++) {
+            rgb[x * 3 + 0] = src[x * 4 + 0];
+            rgb[x * 3 + 1] = src[x * 4 + 1];
+            rgb[x * 3 + 2] = src[x * 4 + 2];
+        }
+        out.write((const char*)rgb.data(), rgb.size());
+    }
+    return (bool)out;
+}
+
+// PNG with uncompressed (stored) deflate blocks: larger files, but writing costs no more than a memcpy
+bool writePNG(const std::string& path, const Image& image) {
+    auto be32 = [](std::vector<uint8_t>& v, uint32_t x) {
+        v.push_back(x >> 24); v.push_back(x >> 16); v.push_back(x >> 8); v.push_back(x);
+    };
+    auto chunk = [&be32](std::ofstream& out, const char* type, const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> header;
+        be32(header, (uint32_t)data.size());
+        header.insert(header.end(), type, type + 4);
+        uint32_t crc = crc32(header.data() + 4, 4);
+        crc = crc32(data.data(), data.size(), crc);
+        std::vector<uint8_t> footer;
+        be32(footer, crc);
+        out.write((const char*)header.data(), header.size());
+        out.write((const char*)data.data(), data.size());
+        out.write((const char*)footer.data(), footer.size());
+    };
+
+    std::ofstream out(path, std::ios::binary);
+    const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.write((const char*)signature, sizeof(signature));
+
+    std::vector<uint8_t> ihdr;
+    be32(ihdr, image.width);
+    be32(ihdr, image.height);
+    ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});                       // 8 bits, RGBA, deflate, no filter, no interlace
+    chunk(out, "IHDR", ihdr);
+
+    // scanlines are prefixed with filter type 0 (none)
+    size_t stride = (size_t)image.width * 4 + 1;
+    std::vector<uint8_t> raw(stride * image.height);
+    for (int y = 0; y < image.height; y++) {
+        raw[y * stride] = 0;
+        std::copy(image.row(y), image.row(y) + image.width * 4, raw.begin() + y * stride + 1);
+    }
+
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    size_t offset = 0;
+    do {
+        size_t length = std::min<size_t>(65535, raw.size() - offset);
+        bool last = offset + length == raw.size();
+        zlib.push_back(last ? 1 : 0);                               // BFINAL, BTYPE = 00 (stored)
+        zlib.push_back(length & 0xFF); zlib.push_back(length >> 8);
+        zlib.push_back(~length & 0xFF); zlib.push_back((~length >> 8) & 0xFF);
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+        offset += length;
+    } while (offset < raw.size());
+    be32(zlib, adler32(raw.data(), raw.size()));
+    chunk(out, "IDAT", zlib);
+    chunk(out, "IEND", {});
+
+    return (bool)out;
+}
+
+bool writeImage(const std::string& path, const Image& image) {
+    bool ppm = path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0;
+    bool ok = ppm ? writePPM(path, image) : writePNG(path, image);
+    if (!ok) std::cout << "ERROR::IMAGE::FAILED TO WRITE " << path << std::endl;
+    return ok;
+}
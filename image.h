@@ -0,0 +1,34 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// 8-bit RGBA pixels, rows stored top to bottom
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;                                    // width * height * 4
+
+    Image() = default;
+    Image(int width, int height) : width(width), height(height), pixels((size_t)width * height * 4) {}
+
+    uint8_t* row(int y) { return pixels.data() + (size_t)y * width * 4; }
+    const uint8_t* row(int y) const { return pixels.data() + (size_t)y * width * 4; }
+};
+
+// [0, 1] -> [0, 255] as a GL_RGBA8 target stores it: clamped, rounded to nearest
+uint8_t unorm8(float value);
+
+// binary PPM (P6, alpha dropped) or PNG, chosen by the file extension; returns false on I/O errors
+bool writeImage(const std::string& path, const Image& image);
+bool writePPM(const std::string& path, const Image& image);
+bool writePNG(const std::string& path, const Image& image);
+
+// PNG pieces, shared with streamed writers that produce the file row by row
+uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+uint32_t adler32(const uint8_t* data, size_t length, uint32_t adler = 1);
+
+#endif
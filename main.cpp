@@ -1,25 +1,93 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "shader.h"
+#include "shader_compiler.h"
+#include "shader_registry.h"
+#include "shader_watcher.h"
+#include "frame_constants.h"
+#include "scene.h"
+#include "frame_profiler.h"
+#include "frame_pacer.h"
+#include "fullscreen_quad.h"
+#include "render_target.h"
+#include "resolution_scaler.h"
+#include "accumulator.h"
+#include "checkerboard.h"
+#include "gl_extensions.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow *window);
+void window_iconify_callback(GLFWwindow* window, int iconified);
+void window_refresh_callback(GLFWwindow* window);
+void processInput(GLFWwindow *window, const ShaderRegistry& registry);
+void drawFrameGraph(Shader& shader, const FullscreenQuad& quad, const FrameProfiler& profiler);
+void present(const RenderTarget& target, GLenum filter);
 
 
 // window settings
 const unsigned int SCREEN_WIDTH = 600;
 const unsigned int SCREEN_HEIGHT = 600;
 
-// key settings
-bool spacePressed = false;
-bool showLighting = false;
+// actual framebuffer size in pixels, differs from the window size on high-DPI displays and after resizing
+int framebufferWidth = SCREEN_WIDTH;
+int framebufferHeight = SCREEN_HEIGHT;
 
-int currentShader = 0;
+// window state from callbacks, nothing is drawn while iconified; exposed or damaged contents set windowDirty
+bool windowIconified = false;
+bool windowDirty = true;
 
+// with --on-demand a converged accumulation stops redrawing after this many samples
+const unsigned int ACCUMULATION_SAMPLES = 256;
 
-int main() {
+// key settings
+bool spacePressed = false;
+bool showLighting = false;
+bool pPressed = false;
+bool showProfiler = false;
+bool aPressed = false;
+bool accumulate = false;                                            // A - hold the current frame and refine it progressively
+bool tPressed = false;
+bool paused = false;                                                // T - stop the animation clock
+bool vPressed = false;
+bool cyclePacing = false;                                           // V - switch to the next frame pacing mode
+bool cPressed = false;
+bool checkerboard = false;                                          // C - shade half the pixels per frame, rebuild the rest
+
+size_t currentShader = 0;
+
+
+int main(int argc, char** argv) {
+
+    // shaders are embedded at build time, --shaders-from-disk reads shaders/ instead (for editing without rebuilding)
+    // and --hot-reload also recompiles programs whenever one of their files changes
+    // --profile-out FILE writes per-frame CPU/GPU timings on exit (.json for percentiles only, anything else is CSV)
+    // --frame-budget MS renders the scene at a lower resolution whenever its GPU time would exceed MS, then upscales
+    // --on-demand sleeps in glfwWaitEvents instead of redrawing while nothing on screen changes (paused, converged)
+    // --pacing vsync|uncapped|limit picks the frame pacing, --fps N is the target rate of the limiter (default 60)
+    // --spheres N replaces the two balls of raytrace with a field of N spheres (see sphere_scene.h)
+    bool hotReload = false;
+    bool onDemand = false;
+    PacingMode pacing = PacingMode::VSync;
+    double targetFps = 60.0;
+    std::string profileOut;
+    float frameBudget = 0.0f;
+    int sphereCount = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--shaders-from-disk") ShaderPreprocessor::readFromDisk = true;
+        if (arg == "--hot-reload") hotReload = ShaderPreprocessor::readFromDisk = true;
+        if (arg == "--profile-out" && i + 1 < argc) profileOut = argv[++i];
+        if (arg == "--frame-budget" && i + 1 < argc) frameBudget = std::stof(argv[++i]);
+        if (arg == "--on-demand") onDemand = true;
+        if (arg == "--pacing" && i + 1 < argc && !FramePacer::parse(argv[++i], pacing)) std::cout << "Unknown pacing mode " << argv[i] << std::endl;
+        if (arg == "--fps" && i + 1 < argc) targetFps = std::stod(argv[++i]);
+        if (arg == "--spheres" && i + 1 < argc) sphereCount = std::max(0, std::stoi(argv[++i]));
+    }
 
     // ---- INIT WINDOW --------------------------------------
 
@@ -44,71 +112,267 @@ int main() {
 
     // GLFW - register window resize callback
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowIconifyCallback(window, window_iconify_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
 
     // GLAD init, load OpenGL function pointers
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);         // optional entry points (program binaries... etc.)
 
 
     // ---- SHADERS --------------------------------------
-    Shader raytraceShader("shaders/default.vert", "shaders/rendering/raytrace.frag");
-    Shader raymarchShader("shaders/default.vert", "shaders/rendering/raymarch.frag");
-    Shader coolRaymarchShader("shaders/default.vert", "shaders/rendering/coolRaymarch.frag");
 
-    Shader* shaders[] = {&raytraceShader, &raymarchShader, &coolRaymarchShader};
+    // per-frame uniforms shared by every program, must exist before any program is linked
+    FrameConstants frameConstants;
+
+    // spheres and lights of raytrace, animated on the CPU and uploaded every frame
+    Scene scene;
+    SphereScene spheres(sphereCount);
+
+    // without GL_KHR_parallel_shader_compile, compile on a thread owning a hidden context that shares our objects
+    std::unique_ptr<ShaderCompiler> compiler;
+    GLFWwindow* compileWindow = NULL;
+    if (!GLAD_GL_KHR_parallel_shader_compile) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        compileWindow = glfwCreateWindow(1, 1, "", NULL, window);
+        if (compileWindow != NULL) {
+            compiler = std::make_unique<ShaderCompiler>(
+                [compileWindow] { glfwMakeContextCurrent(compileWindow); },
+                [] { glfwMakeContextCurrent(NULL); });
+            Shader::backgroundCompiler = compiler.get();
+        }
+    }
+
+    // cheap program shown while the selected demo is still compiling
+    Shader placeholderShader("shaders/default.vert", "shaders/placeholder.frag");
+
+    // demos are compiled on first use, keys 1..9 select them in this order.
+    // lighting and checkerboard rendering are compile-time permutations (index = showLighting + 2 * checkerboard),
+    // SPACE and C swap between prebuilt programs
+    ShaderRegistry registry("shaders/default.vert", "shaders/rendering", {"raytrace", "raymarch", "coolRaymarch"},
+                            {{{"LIGHTING", "0"}}, {{"LIGHTING", "1"}},
+                             {{"LIGHTING", "0"}, {"CHECKERBOARD", "1"}}, {{"LIGHTING", "1"}, {"CHECKERBOARD", "1"}}});
+    if (registry.size() == 0) {
+        std::cout << "No shaders found in shaders/rendering" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+    std::unique_ptr<ShaderWatcher> watcher;
+    if (hotReload) watcher = std::make_unique<ShaderWatcher>("shaders");
 
 
     // ---- SETUP VERTEX DATA --------------------------------------
-    float vertices[] = {
-        // positions
-        1.0f, -1.0f, 0.0f,       // bottom right
-        -1.0f, -1.0f, 0.0f,      // bottom left
-        1.0f, 1.0f, 0.0f,        // top right
-        -1.0f, 1.0f, 0.0f,     // top left
-    };
+    FullscreenQuad quad;
+
 
-    unsigned int VBO, VAO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);                          // generate unique buffer ID for VBO
-    glBindVertexArray(VAO);                         // bind Vertex Array Object
+    // ---- PROFILING --------------------------------------
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);             // bind buffer to `GL_ARRAY_BUFFER` target
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);                      // copies vertex data to currently bound buffer (VBO)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);                   // set vertex attribute pointers
-    glEnableVertexAttribArray(0);
+    // P toggles the frame time graph, percentiles go to the window title
+    FrameProfiler profiler;
+    Shader frameGraphShader("shaders/default.vert", "shaders/overlay/frame_graph.frag");
+    double titleUpdate = 0.0;
+
+    // explicit swap interval, the driver default differs between platforms; V cycles the modes
+    FramePacer pacer(pacing, targetFps);
+    glfwSwapInterval(pacer.swapInterval());
+
+
+    // ---- DYNAMIC RESOLUTION --------------------------------------
+
+    // the scene goes into sceneTarget at scaler->scale() of the framebuffer size and is upscaled when presenting
+    std::unique_ptr<ResolutionScaler> scaler;
+    std::unique_ptr<RenderTarget> sceneTarget;
+    uint64_t gpuSamplesSeen = 0;
+    if (frameBudget > 0.0f) {
+        scaler = std::make_unique<ResolutionScaler>(frameBudget);
+        sceneTarget = std::make_unique<RenderTarget>(framebufferWidth, framebufferHeight);
+    }
+
+    // created on first use, three float targets of the window size
+    std::unique_ptr<Accumulator> accumulator;
+    std::unique_ptr<CheckerboardRenderer> checker;
+
+
+    // ---- REDRAW ON DEMAND --------------------------------------
+
+    // animation clock, only advances while not paused
+    double animationTime = glfwGetTime();
+    double lastClock = animationTime;
+    auto tick = [&] {
+        double now = glfwGetTime();
+        if (!paused) animationTime += now - lastClock;
+        lastClock = now;
+    };
+
+    // everything that changes the image while paused, a frame is drawn when it differs from the last one drawn
+    struct ViewState {
+        const Shader* program;
+        ShaderStatus status;
+        size_t shader;
+        bool lighting, checkerboard, accumulate, paused, profiler;
+        int width, height;
+        bool operator==(const ViewState&) const = default;
+    };
+    auto viewState = [&] {
+        Shader* program = registry.get(currentShader, (showLighting ? 1 : 0) + (checkerboard && !accumulate ? 2 : 0));
+        return ViewState{program, program->status(), currentShader, showLighting, checkerboard, accumulate, paused, showProfiler,
+                         framebufferWidth, framebufferHeight};
+    };
+    ViewState drawn = {};
+    int settleFrames = 0;                                           // frames to draw after a change, checkerboard needs both halves
+
+    auto needsRedraw = [&] {
+        if (windowIconified || framebufferWidth == 0 || framebufferHeight == 0) return false;
+        if (!onDemand || !paused || windowDirty || settleFrames > 0) return true;
+        if (accumulate && accumulator && accumulator->sampleCount() < ACCUMULATION_SAMPLES) return true;
+        return !(viewState() == drawn);
+    };
 
 
     // ---- RENDER LOOP --------------------------------------
     while (!glfwWindowShouldClose(window)) {
+        profiler.beginFrame();
 
         // input
-        processInput(window);
+        tick();
+        processInput(window, registry);
+        if (cyclePacing) {
+            cyclePacing = false;
+            pacer.setMode((PacingMode)(((int)pacer.mode() + 1) % 3));
+            glfwSwapInterval(pacer.swapInterval());
+            std::cout << "Frame pacing: " << FramePacer::name(pacer.mode()) << std::endl;
+        }
+
+        // hot reload - recompile changed programs in the background, swap them in once they link
+        if (watcher) registry.reload(watcher->poll());
+        registry.update();
+        profiler.endSection(FrameSection::Input);
+
+        // accumulation wants every pixel of every sample, it takes precedence over checkerboard rendering
+        bool checkered = checkerboard && !accumulate;
+        Shader* shader = registry.get(currentShader, (showLighting ? 1 : 0) + (checkered ? 2 : 0));
+        if (shader->status() != ShaderStatus::Ready) {
+            shader = &placeholderShader;
+            checkered = false;
+        }
+
+        FrameConstantsData constants;
+        constants.iTime = (float)animationTime;
+
+        // accumulation renders at full size, one jittered sample per frame, and starts over whenever the image would change
+        int renderWidth = framebufferWidth, renderHeight = framebufferHeight;
+        if (accumulate) {
+            if (!accumulator) accumulator = std::make_unique<Accumulator>(framebufferWidth, framebufferHeight);
+            accumulator->begin({shader, constants.iTime, framebufferWidth, framebufferHeight});
+            accumulator->jitter(constants.iJitter[0], constants.iJitter[1]);
+            accumulator->sampleTarget().bind();
+        }
+
+        // otherwise pick the render size from the newest GPU timing, results arrive a few frames late
+        else if (scaler) {
+            if (profiler.gpuDrawSamples() != gpuSamplesSeen) {
+                gpuSamplesSeen = profiler.gpuDrawSamples();
+                scaler->update(profiler.latestGpuDraw());
+            }
+            scaler->renderSize(framebufferWidth, framebufferHeight, renderWidth, renderHeight);
+            if (renderWidth != sceneTarget->width() || renderHeight != sceneTarget->height()) sceneTarget->resize(renderWidth, renderHeight);
+            sceneTarget->bind();
+        }
+
+        // checkerboard samples go into a half-width target, at the scaled size if dynamic resolution is on
+        if (checkered) {
+            if (!checker) checker = std::make_unique<CheckerboardRenderer>(renderWidth, renderHeight);
+            checker->begin(shader, renderWidth, renderHeight);
+            constants.iFrame = checker->frameIndex();
+            checker->halfTarget().bind();
+        }
+
+        // set uniforms, one buffer update for every program drawn this frame
+        constants.iResolution[0] = (float)renderWidth;
+        constants.iResolution[1] = (float)renderHeight;
+        frameConstants.update(constants);
+        spheres.animate(constants.iTime);
+        scene.update(spheres);
+        profiler.endSection(FrameSection::Upload);
 
         // render
+        profiler.beginGpu();
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        shaders[currentShader]->use();
-
-        // set uniforms
-        shaders[currentShader]->setVec2("iResolution", SCREEN_WIDTH, SCREEN_HEIGHT);
-        shaders[currentShader]->setFloat("iTime", glfwGetTime());
-        shaders[currentShader]->setBool("showLighting", showLighting);
-
-        // draw triangles
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        
+        shader->use();
+        quad.draw();                                // draw triangles
+
+        // show the running mean, or upscale the scaled render to the window
+        if (accumulate) {
+            accumulator->accumulate(quad);
+            present(accumulator->result(), GL_NEAREST);
+        }
+        else if (checkered) {
+            checker->resolve(quad);
+            present(checker->result(), GL_LINEAR);
+        }
+        else if (scaler) present(*sceneTarget, GL_LINEAR);
+        profiler.endGpu();
+
+        if (showProfiler) drawFrameGraph(frameGraphShader, quad, profiler);
+        profiler.endSection(FrameSection::Draw);
+
+        pacer.wait();                               // software frame limiter, returns immediately unless limiting
         glfwSwapBuffers(window);                    // swap buffers (double buffer - separate output and rendering buffer to reduce artifacts)
+        pacer.presented();
         glfwPollEvents();                           // checks for keyboard input, mouse movement... etc.
+
+        registry.prewarm(currentShader);            // compile the other demos in the background once this one is up
+        profiler.endSection(FrameSection::Swap);
+        profiler.endFrame();
+
+        // remember what is on screen, a change gets a couple of frames so checkerboard and double buffering settle
+        ViewState current = viewState();
+        bool changed = windowDirty || !(current == drawn);
+        if (changed) settleFrames = 2;
+        else if (settleFrames > 0) settleFrames--;
+        drawn = current;
+        windowDirty = false;
+
+        if (glfwGetTime() - titleUpdate > 0.5 || changed) {
+            titleUpdate = glfwGetTime();
+            std::string title = "OpenGL";
+            if (paused) title += " | paused";
+            if (showProfiler) title += " | " + profiler.summary() + " | " + pacer.summary();
+            if (showProfiler && scaler) title += " | " + std::to_string(renderWidth) + "x" + std::to_string(renderHeight);
+            if (accumulate) title += " | " + std::to_string(accumulator->sampleCount()) + " samples";
+            glfwSetWindowTitle(window, title.c_str());
+        }
+
+        // idle until something changes, still waking up now and then while programs compile or files are watched
+        if (!needsRedraw()) pacer.reset();                          // the idle gap is not a frame interval
+        while (!glfwWindowShouldClose(window) && !needsRedraw()) {
+            if (registry.busy()) glfwWaitEventsTimeout(0.05);
+            else if (watcher || windowIconified) glfwWaitEventsTimeout(0.25);
+            else glfwWaitEvents();
+
+            tick();
+            processInput(window, registry);
+            if (watcher) registry.reload(watcher->poll());
+            registry.update();
+            registry.prewarm(currentShader);
+        }
     }
+
+    if (!profileOut.empty()) profiler.write(profileOut);
+    std::cout << "Frame pacing: " << pacer.summary() << std::endl;
     
 
-    // deallocate resources
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
+    // stop the compile thread while its context still exists
+    compiler.reset();
+    Shader::backgroundCompiler = nullptr;
+    if (compileWindow != NULL) glfwDestroyWindow(compileWindow);
 
     // terminate window
     glfwTerminate();
@@ -118,12 +382,25 @@ int main() {
 
 // GLFW - callback function to account for window resizing
 void framebuffer_size_callback([[maybe_unused]] GLFWwindow* window, int width, int height) {
-    // tell OpenGL the size of the rendering viewport
+    // tell OpenGL the size of the rendering viewport, iResolution and the scene target follow next frame
     glViewport(0, 0, width, height);
+    framebufferWidth = width;
+    framebufferHeight = height;
+}
+
+// GLFW - minimized windows are not drawn at all
+void window_iconify_callback([[maybe_unused]] GLFWwindow* window, int iconified) {
+    windowIconified = iconified;
+    windowDirty = true;
+}
+
+// GLFW - the window contents were damaged (uncovered, moved between screens... etc.) and have to be drawn again
+void window_refresh_callback([[maybe_unused]] GLFWwindow* window) {
+    windowDirty = true;
 }
 
 // GLFW - process input, queries GLFW to detect if certain keys are pressed/released this frame
-void processInput(GLFWwindow *window) {
+void processInput(GLFWwindow *window, const ShaderRegistry& registry) {
     // close the window if user presses "ESC" key
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(window, true);
 
@@ -136,8 +413,80 @@ void processInput(GLFWwindow *window) {
     // reset flag when key is released
     if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE && spacePressed) spacePressed = false;
 
-    // control which shader is currently used
-    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) currentShader = 0;
-    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) currentShader = 1;
-    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) currentShader = 2;
+    // toggle the frame time graph when P is pressed
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS && !pPressed) {
+        pPressed = true;
+        showProfiler = !showProfiler;
+    }
+    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE && pPressed) pPressed = false;
+
+    // toggle accumulation when A is pressed, the animation holds while it is on
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS && !aPressed) {
+        aPressed = true;
+        accumulate = !accumulate;
+        paused = accumulate;
+    }
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_RELEASE && aPressed) aPressed = false;
+
+    // pause/resume the animation when T is pressed
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !tPressed) {
+        tPressed = true;
+        paused = !paused;
+    }
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE && tPressed) tPressed = false;
+
+    // next frame pacing mode when V is pressed, applied by the render loop
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS && !vPressed) {
+        vPressed = true;
+        cyclePacing = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE && vPressed) vPressed = false;
+
+    // toggle checkerboard rendering when C is pressed
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS && !cPressed) {
+        cPressed = true;
+        checkerboard = !checkerboard;
+    }
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE && cPressed) cPressed = false;
+
+    // control which shader is currently used, number keys follow the registry order
+    for (size_t i = 0; i < registry.size() && i < 9; i++) {
+        if (glfwGetKey(window, GLFW_KEY_1 + (int)i) == GLFW_PRESS) currentShader = i;
+    }
+}
+
+// frame time graph in the top-left corner, blended over the scene
+void drawFrameGraph(Shader& shader, const FullscreenQuad& quad, const FrameProfiler& profiler) {
+    const int samples = 120, width = 240, height = 80, margin = 10;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    int x = margin, y = viewport[3] - height - margin;
+
+    std::vector<float> times = profiler.graph(FrameProfiler::Metric::CpuTotal, samples);
+    float scale = 1000.0f / 20.0f;                                  // 50ms, grows to fit the slowest frame shown
+    for (float t : times) scale = std::max(scale, t * 1.1f);
+
+    glViewport(x, y, width, height);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    shader.use();
+    shader.setFloats("frameTimes"_u, times.data(), samples);
+    shader.setVec2("graphOrigin"_u, (float)x, (float)y);
+    shader.setVec2("graphSize"_u, (float)width, (float)height);
+    shader.setFloat("graphScale"_u, scale);
+    quad.draw();
+
+    glDisable(GL_BLEND);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+// copy an offscreen target to the whole window, stretching it when the sizes differ
+void present(const RenderTarget& target, GLenum filter) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target.framebuffer());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, target.width(), target.height(), 0, 0, framebufferWidth, framebufferHeight, GL_COLOR_BUFFER_BIT, filter);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
 }
@@ -0,0 +1,59 @@
+#include "mapped_image.h"
+
+#include <cstdio>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+MappedImage::MappedImage(const std::string& path, int width, int height) : w(width), h(height) {
+    char header[64];
+    headerSize = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", w, h);
+
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cout << "ERROR::MAPPED_IMAGE::FAILED TO CREATE " << path << std::endl;
+        return;
+    }
+
+    // sparse file of the final size, rows are filled in through the mappings
+    if (write(fd, header, headerSize) != (ssize_t)headerSize || ftruncate(fd, (off_t)(headerSize + rowBytes() * h)) != 0) {
+        std::cout << "ERROR::MAPPED_IMAGE::FAILED TO ALLOCATE " << path << " (" << headerSize + rowBytes() * h << " bytes)" << std::endl;
+        close(fd);
+        fd = -1;
+    }
+}
+
+MappedImage::~MappedImage() {
+    flush();
+    if (fd >= 0) close(fd);
+}
+
+uint8_t* MappedImage::mapRows(int y, int rows) {
+    if (!flush() || fd < 0) return nullptr;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = headerSize + rowBytes() * y;
+    size_t aligned = begin / page * page;                           // mmap offsets must be page aligned
+    mappingSkip = begin - aligned;
+    mappingSize = mappingSkip + rowBytes() * rows;
+
+    mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t)aligned);
+    if (mapping == MAP_FAILED) {
+        std::cout << "ERROR::MAPPED_IMAGE::MMAP_FAILED rows " << y << "-" << y + rows << std::endl;
+        mapping = nullptr;
+        return nullptr;
+    }
+    return (uint8_t*)mapping + mappingSkip;
+}
+
+bool MappedImage::flush() {
+    if (!mapping) return true;
+
+    // write back asynchronously, munmap keeps the dirty pages in the page cache rather than in this process
+    bool ok = msync(mapping, mappingSize, MS_ASYNC) == 0;
+    ok &= munmap(mapping, mappingSize) == 0;
+    mapping = nullptr;
+    return ok;
+}
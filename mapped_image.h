@@ -0,0 +1,37 @@
+#ifndef MAPPED_IMAGE_H
+#define MAPPED_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+// Binary PPM (P6) written through memory mappings of one band of rows at a time, for images larger than memory.
+// The file is created at full size up front; only the mapped band is resident and it is written back by the
+// kernel when the next band is mapped, so memory stays bounded by the band size whatever the image size.
+// POSIX (mmap) only.
+class MappedImage {
+    int fd = -1;
+    int w, h;
+    size_t headerSize = 0;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    size_t mappingSkip = 0;                                         // bytes between the page-aligned mapping start and the first row
+
+public:
+    MappedImage(const std::string& path, int width, int height);
+    ~MappedImage();
+    MappedImage(const MappedImage&) = delete;
+    MappedImage& operator=(const MappedImage&) = delete;
+
+    bool valid() const { return fd >= 0; }
+    int width() const { return w; }
+    int height() const { return h; }
+    size_t rowBytes() const { return (size_t)w * 3; }
+
+    // maps rows [y, y + rows) (top to bottom, RGB8), unmapping the previous band; null on failure
+    uint8_t* mapRows(int y, int rows);
+    bool flush();                                                   // unmaps the current band, false if writing it back failed
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "render_target.h"
+
+#include <algorithm>
+#include <iostream>
+
+
+RenderTarget::RenderTarget(int width, int height, GLenum internalFormat) : internalFormat(internalFormat) {
+    glGenFramebuffers(1, &FBO);
+    glGenTextures(1, &texture);
+    resize(width, height);
+}
+
+RenderTarget::~RenderTarget() {
+    glDeleteTextures(1, &texture);
+    glDeleteFramebuffers(1, &FBO);
+}
+
+void RenderTarget::resize(int width, int height) {
+    w = std::max(width, 1);
+    h = std::max(height, 1);
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::RENDER_TARGET::FRAMEBUFFER_INCOMPLETE " << w << "x" << h << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glViewport(0, 0, w, h);
+}
+
+Image RenderTarget::read() const {
+    Image image(w, h);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+
+    // GL rows start at the bottom
+    for (int y = 0; y < h / 2; y++) {
+        std::swap_ranges(image.row(y), image.row(y) + w * 4, image.row(h - 1 - y));
+    }
+    return image;
+}
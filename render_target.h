@@ -0,0 +1,32 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <glad/glad.h>
+
+#include "image.h"
+
+
+// Offscreen framebuffer with a single color texture
+class RenderTarget {
+    unsigned int FBO = 0, texture = 0;
+    GLenum internalFormat;
+    int w = 0, h = 0;
+
+public:
+    RenderTarget(int width, int height, GLenum internalFormat = GL_RGBA8);
+    ~RenderTarget();
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    void resize(int width, int height);                             // contents are undefined afterwards
+    void bind() const;                                              // binds the FBO and sets the viewport to cover it
+
+    int width() const { return w; }
+    int height() const { return h; }
+    unsigned int colorTexture() const { return texture; }
+    unsigned int framebuffer() const { return FBO; }
+
+    Image read() const;                                             // synchronous glReadPixels, for tools and tests
+};
+
+#endif
@@ -0,0 +1,47 @@
+#include "resolution_scaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+    const float SMOOTHING = 0.2f;                                   // weight of the newest sample
+    const float HEADROOM = 0.9f;                                    // aim below the budget so noise doesn't overshoot it
+    const float HOLD = 0.75f;                                       // no upscaling while above HOLD x budget, avoids oscillating
+    const float MAX_DOWN = 0.90f, MAX_UP = 1.03f;                   // per-update limits, react to spikes faster than to slack
+    const int COOLDOWN = 4;
+}
+
+
+ResolutionScaler::ResolutionScaler(float budgetMs, float minScale, float maxScale)
+    : budget(budgetMs), minScale(minScale), maxScale(maxScale), current(maxScale) {}
+
+float ResolutionScaler::update(float frameMs) {
+    if (frameMs <= 0.0f) return current;
+    if (cooldown > 0) {
+        cooldown--;
+        return current;
+    }
+
+    smoothed = smoothed < 0.0f ? frameMs : smoothed + (frameMs - smoothed) * SMOOTHING;
+    if (smoothed <= budget && smoothed >= HOLD * budget) return current;
+
+    float factor = std::clamp(std::sqrt(HEADROOM * budget / smoothed), MAX_DOWN, MAX_UP);
+    float next = std::clamp(current * factor, minScale, maxScale);
+    if (std::abs(next - current) < 0.005f) return current;
+
+    // the average was measured at the old scale, rescale it instead of starting over
+    smoothed *= (next * next) / (current * current);
+    current = next;
+    cooldown = COOLDOWN;
+    return current;
+}
+
+void ResolutionScaler::renderSize(int framebufferWidth, int framebufferHeight, int& width, int& height) const {
+    auto scaled = [this](int size) {
+        int s = (int)std::lround(size * current / 8.0f) * 8;
+        return std::clamp(s, std::min(size, 8), size);
+    };
+    width = scaled(framebufferWidth);
+    height = scaled(framebufferHeight);
+}
@@ -0,0 +1,28 @@
+#ifndef RESOLUTION_SCALER_H
+#define RESOLUTION_SCALER_H
+
+
+// Picks the render resolution scale that keeps the GPU time of a frame under a budget.
+// Cost is roughly proportional to the pixel count, so the scale moves with sqrt(budget / time),
+// a few percent per frame at most, and waits for fresh measurements after every change.
+class ResolutionScaler {
+    float budget;                                                   // ms
+    float minScale, maxScale;
+    float current;
+    float smoothed = -1.0f;                                         // exponential average of the measured ms, -1 before the first sample
+    int cooldown = 0;                                               // samples to skip after a change, timer results lag a few frames
+
+public:
+    ResolutionScaler(float budgetMs, float minScale = 0.25f, float maxScale = 1.0f);
+
+    // feed the GPU time of one frame rendered at the current scale, returns the scale to use from now on
+    float update(float frameMs);
+
+    float scale() const { return current; }
+    float frameBudget() const { return budget; }
+
+    // render size for a framebuffer at the current scale, rounded to multiples of 8 so small changes don't reallocate
+    void renderSize(int framebufferWidth, int framebufferHeight, int& width, int& height) const;
+};
+
+#endif
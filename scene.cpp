@@ -0,0 +1,62 @@
+#include "scene.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "shader.h"
+
+
+Scene::Scene() {
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(SceneConstantsData), NULL, GL_STREAM_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, UBO);
+
+    glGenBuffers(2, buffers);
+    glGenTextures(2, textures);
+    const int units[2] = {SPHERE_UNIT, LIGHT_UNIT};
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);  // a texture buffer needs storage to attach
+        glActiveTexture(GL_TEXTURE0 + units[i]);
+        glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffers[i]);
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    Shader::setBlockBinding("SceneConstants", BINDING);
+    Shader::setSamplerBinding("sceneSpheres", SPHERE_UNIT);
+    Shader::setSamplerBinding("sceneLights", LIGHT_UNIT);
+
+    update(SphereScene());
+}
+
+Scene::~Scene() {
+    glDeleteTextures(2, textures);
+    glDeleteBuffers(2, buffers);
+    glDeleteBuffers(1, &UBO);
+}
+
+void Scene::update(const SphereScene& scene) {
+    SceneConstantsData constants;
+    constants.sphereCount = (int32_t)std::min(scene.spheres.size(), (size_t)maxTexels);
+    constants.lightCount = (int32_t)std::min(scene.lights.size(), (size_t)maxTexels);
+    if ((size_t)constants.sphereCount < scene.spheres.size()) {
+        std::cout << "ERROR::SCENE::TOO_MANY_SPHERES " << scene.spheres.size() << ", drawing the first " << maxTexels << std::endl;
+    }
+
+    // orphan, frames in flight keep the old storage; the texture buffer follows the new one
+    const void* data[2] = {scene.spheres.data(), scene.lights.data()};
+    const size_t sizes[2] = {(size_t)constants.sphereCount * sizeof(SceneSphere), (size_t)constants.lightCount * sizeof(SceneLight)};
+    for (int i = 0; i < 2; i++) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, std::max(sizes[i], (size_t)16), NULL, GL_STREAM_DRAW);
+        if (sizes[i] > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, sizes[i], data[i]);
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(SceneConstantsData), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(SceneConstantsData), &constants);
+}
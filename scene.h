@@ -0,0 +1,41 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glad/glad.h>
+#include <cstdint>
+
+#include "sphere_scene.h"
+
+
+// CPU mirror of the std140 "SceneConstants" uniform block in shaders/lib/scene.glsl
+struct SceneConstantsData {
+    int32_t sphereCount = 0;                                        // offset 0
+    int32_t lightCount = 0;                                         // offset 4
+    int32_t padding[2] = {};
+};
+static_assert(sizeof(SceneConstantsData) == 16, "must match the std140 layout of SceneConstants");
+
+
+// Scene data of raytrace.frag on the GPU: spheres and lights in two RGBA32F texture buffers (one texel each, GL 3.3
+// guarantees 65536 texels where a uniform block holds 4096 vec4), their counts in a uniform block.
+// The textures stay bound on their own units for the life of the object, out of the way of the post passes.
+class Scene {
+    unsigned int UBO = 0;
+    unsigned int buffers[2] = {};                                   // spheres, lights
+    unsigned int textures[2] = {};
+    int maxTexels = 0;                                              // GL_MAX_TEXTURE_BUFFER_SIZE
+
+public:
+    static const unsigned int BINDING = 1;
+    static const int SPHERE_UNIT = 14;                              // texture units, GL 3.3 has at least 16
+    static const int LIGHT_UNIT = 15;
+
+    Scene();                                                        // create before linking programs, holds the default scene
+    ~Scene();
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    void update(const SphereScene& scene);                          // orphans the previous storage, never waits on the GPU
+};
+
+#endif
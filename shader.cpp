@@ -1,60 +1,98 @@
 #include "shader.h"
 
-std::string Shader::read_file(const char* filename) {
-    std::ifstream in;
-    std::stringstream buffer;
-    std::string shaderCode;
-
-    try {
-        in.open(filename);
-        buffer << in.rdbuf();
-        in.close();
-        shaderCode = buffer.str();
-
-    } catch(std::ifstream::failure e) {
-        std::cout << "ERROR::SHADER::FAILED TO READ " << filename << std::endl;
-    }
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+#include "gl_extensions.h"
+#include "shader_compiler.h"
+
+ShaderCompiler* Shader::backgroundCompiler = nullptr;
 
-    return shaderCode;
+std::string Shader::permutationKey(const ShaderDefines& defines) {
+    std::string key;
+    for (const auto& [name, value] : defines) key += name + "=" + value + ";";
+    return key;
 }
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath) {
+Shader::Shader(const char* vertexPath, const char* fragmentPath, CompileMode mode, const ShaderDefines& defines) {
+
+    // Retrieve the vertex and fragment source code from filepath, with includes expanded and the permutation defines injected
+    ShaderPreprocessor::Result vertex = ShaderPreprocessor::process(vertexPath, defines);
+    ShaderPreprocessor::Result fragment = ShaderPreprocessor::process(fragmentPath, defines);
+    std::string vertexCode = std::move(vertex.source);
+    std::string fragmentCode = std::move(fragment.source);
+    vertexFiles = std::move(vertex.files);
+    fragmentFiles = std::move(fragment.files);
+
+    // Reuse a cached program binary when possible, otherwise compile from source and cache the result
+    binaryKey = binary_key(vertexCode, fragmentCode);
+    if (load_binary(binaryKey)) {
+        load_uniforms();
+        state = ShaderStatus::Ready;
+        return;
+    }
+
+    if (mode == CompileMode::Async && GLAD_GL_KHR_parallel_shader_compile) {
+        start_compile(vertexCode, fragmentCode);                    // the driver compiles on its own threads, status() polls for completion
 
-    // Retrieve the vertex and fragment source code from filepath
-    std::string vertexCode = read_file(vertexPath);
-    std::string fragmentCode = read_file(fragmentPath);
+    } else if (mode == CompileMode::Async && backgroundCompiler) {
+        workerBusy = true;
+        backgroundCompiler->submit([this, vertexCode = std::move(vertexCode), fragmentCode = std::move(fragmentCode)] {
+            start_compile(vertexCode, fragmentCode);
+            glFinish();                                             // results must be complete before the main context looks at them
+            workerBusy.store(false, std::memory_order_release);
+            workerBusy.notify_all();
+        });
+
+    } else {
+        start_compile(vertexCode, fragmentCode);
+        finish_compile();
+    }
+}
+
+// Issue compile and link without querying any status, so the driver is free to work asynchronously
+void Shader::start_compile(const std::string& vertexCode, const std::string& fragmentCode) {
     const char* vertexSource = vertexCode.c_str();
     const char* fragmentSource = fragmentCode.c_str();
 
     // Compile shaders
-    unsigned int vertexShader, fragmentShader;
-    int success;
-    char infoLog[512];
-    
     vertexShader = glCreateShader(GL_VERTEX_SHADER);                // create shader
     glShaderSource(vertexShader, 1, &vertexSource, NULL);           // attach shader source code to shader
     glCompileShader(vertexShader);                                  // compile shader
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
 
     fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);            // create shader
     glShaderSource(fragmentShader, 1, &fragmentSource, NULL);       // attach shader source code to shader
     glCompileShader(fragmentShader);                                // compile shader
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-
 
     // Link shaders
     ID = glCreateProgram();
+    if (GLAD_GL_ARB_get_program_binary) glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glAttachShader(ID, vertexShader);
     glAttachShader(ID, fragmentShader);
     glLinkProgram(ID);
+}
+
+// Check the results of start_compile(), blocks if the driver has not finished yet
+void Shader::finish_compile() {
+    int success;
+    char infoLog[512];
+
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << describe_sources(vertexFiles) << std::endl;
+    }
+
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << describe_sources(fragmentFiles) << std::endl;
+    }
     
     // check for linking errors
     glGetProgramiv(ID, GL_LINK_STATUS, &success);
@@ -65,27 +103,310 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+    vertexShader = fragmentShader = 0;
+
+    if (success) {
+        save_binary(binaryKey);
+        load_uniforms();
+        state = ShaderStatus::Ready;
+    } else {
+        state = ShaderStatus::Failed;
+    }
+}
+
+// Legend for the source string numbers in driver messages, e.g. "1:42(7)" is line 42 of files[1]
+std::string Shader::describe_sources(const std::vector<std::string>& files) {
+    std::string legend;
+    for (size_t i = 0; i < files.size(); i++) legend += "  source " + std::to_string(i) + ": " + files[i] + "\n";
+    return legend;
+}
+
+std::vector<std::string> Shader::dependencies() const {
+    std::vector<std::string> files = vertexFiles;
+    files.insert(files.end(), fragmentFiles.begin(), fragmentFiles.end());
+    return files;
 }
 
+ShaderStatus Shader::status() {
+    if (state != ShaderStatus::Pending) return state;
+    if (workerBusy.load(std::memory_order_acquire)) return state;
+
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        int done = GL_FALSE;
+        glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done) return state;
+    }
+
+    finish_compile();
+    return state;
+}
+
+ShaderStatus Shader::wait() {
+    workerBusy.wait(true, std::memory_order_acquire);
+    if (state == ShaderStatus::Pending) finish_compile();
+    return state;
+}
+
+
+// ---- PROGRAM BINARY CACHE --------------------------------------
+// <cacheDirectory>/<key>.bin = BinaryHeader followed by the driver blob
+
+namespace {
+    struct BinaryHeader {
+        char magic[4];                                              // "GLPB"
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;                                            // binaryFormat returned by glGetProgramBinary
+        uint32_t length;
+    };
+
+    const uint32_t BINARY_VERSION = 1;
+    const uint32_t MAX_BINARY_LENGTH = 256u << 20;                  // far above any real program, guards the allocation
+
+    uint64_t hash64(std::string_view data, uint64_t hash = 14695981039346656037ull) {
+        for (char c : data) {
+            hash ^= (uint8_t)c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // shader_cache/ next to the running executable, so every tool shares one cache whatever directory it is started
+    // from; SHADER_CACHE_DIR overrides it, an empty value disables caching
+    std::string defaultCacheDirectory() {
+        if (const char* directory = std::getenv("SHADER_CACHE_DIR")) return directory;
+
+        std::filesystem::path executable;
+#ifdef __APPLE__
+        char path[4096];
+        uint32_t size = sizeof(path);
+        if (_NSGetExecutablePath(path, &size) == 0) executable = path;
+#else
+        std::error_code error;
+        executable = std::filesystem::read_symlink("/proc/self/exe", error);
+#endif
+        if (executable.empty()) return "shader_cache";              // unknown, fall back to the working directory
+        return (executable.parent_path() / "shader_cache").string();
+    }
+}
+
+std::string Shader::cacheDirectory = defaultCacheDirectory();
+std::map<std::string, unsigned int> Shader::blockBindings;
+std::map<std::string, int> Shader::samplerBindings;
+
+// Blobs are only valid for the exact driver that produced them, so the renderer/version are part of the key
+uint64_t Shader::binary_key(const std::string& vertexCode, const std::string& fragmentCode) {
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    const char* version = (const char*)glGetString(GL_VERSION);
+
+    uint64_t hash = hash64(vertexCode);
+    hash = hash64(std::string_view("\0", 1), hash);                 // separator so sources can't shift between stages
+    hash = hash64(fragmentCode, hash);
+    hash = hash64(renderer ? renderer : "", hash);
+    hash = hash64(version ? version : "", hash);
+    return hash;
+}
+
+std::filesystem::path Shader::binary_path(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return std::filesystem::path(cacheDirectory) / name;
+}
+
+bool Shader::load_binary(uint64_t key) {
+    if (!GLAD_GL_ARB_get_program_binary || cacheDirectory.empty()) return false;
+
+    std::ifstream in(binary_path(key), std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::streamoff fileSize = in.tellg();
+    in.seekg(0);
+
+    // the blob must fill the rest of the file exactly, a truncated or corrupt file falls back to compiling
+    BinaryHeader header;
+    if (!in.read((char*)&header, sizeof(header)) || memcmp(header.magic, "GLPB", 4) != 0 ||
+        header.version != BINARY_VERSION || header.key != key) return false;
+    if (header.length == 0 || header.length > MAX_BINARY_LENGTH ||
+        (std::streamoff)header.length != fileSize - (std::streamoff)sizeof(header)) {
+        std::cout << "WARNING::SHADER::PROGRAM::CORRUPT_BINARY " << binary_path(key).string() << std::endl;
+        return false;
+    }
+
+    std::vector<char> blob(header.length);
+    if (!in.read(blob.data(), blob.size())) return false;
+
+    // the driver may still reject the blob (e.g. after a driver update without a version change)
+    ID = glCreateProgram();
+    glProgramBinary(ID, header.format, blob.data(), header.length);
+
+    int success;
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success) {
+        std::cout << "WARNING::SHADER::PROGRAM::STALE_BINARY " << binary_path(key).string() << std::endl;
+        glDeleteProgram(ID);
+        ID = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void Shader::save_binary(uint64_t key) {
+    if (!GLAD_GL_ARB_get_program_binary || cacheDirectory.empty()) return;
+
+    int length = 0;
+    glGetProgramiv(ID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0 || (uint32_t)length > MAX_BINARY_LENGTH) return;
+
+    std::vector<char> blob(length);
+    GLenum format;
+    glGetProgramBinary(ID, length, &length, &format, blob.data());
+    if (length <= 0 || (size_t)length > blob.size()) return;       // nothing sane to cache
+
+    BinaryHeader header = {{'G', 'L', 'P', 'B'}, BINARY_VERSION, key, format, (uint32_t)length};
+
+    // write to a temporary file and rename, so a crash never leaves a truncated blob behind
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+    std::filesystem::path path = binary_path(key);
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+
+    std::ofstream out(tmp, std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write(blob.data(), length);
+    out.close();
+
+    if (out) std::filesystem::rename(tmp, path, error);
+    if (!out || error) {
+        std::cout << "WARNING::SHADER::PROGRAM::CACHE_WRITE_FAILED " << path.string() << std::endl;
+        std::filesystem::remove(tmp, error);
+    }
+}
+
+// Enumerate the active uniforms once so setters never have to ask the driver for locations
+void Shader::load_uniforms() {
+    uniforms.clear();
+
+    int count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> name(maxLength > 0 ? maxLength : 1);
+
+    for (int i = 0; i < count; i++) {
+        GLsizei length = 0;
+        Uniform u{};
+        glGetActiveUniform(ID, i, (GLsizei)name.size(), &length, &u.size, &u.type, name.data());
+
+        std::string_view view(name.data(), length);
+        if (view.ends_with("[0]")) view.remove_suffix(3);          // arrays are reported as "name[0]"
+
+        u.location = glGetUniformLocation(ID, name.data());
+        if (u.location < 0) continue;                               // uniform block members have no location
+        u.hash = hashName(view);
+        uniforms.push_back(u);
+    }
+
+    std::sort(uniforms.begin(), uniforms.end(), [](const Uniform& a, const Uniform& b) { return a.hash < b.hash; });
+
+    // GLSL 330 has no layout(binding = N), so shared blocks are bound to their fixed binding point here
+    for (const auto& [blockName, binding] : blockBindings) {
+        unsigned int index = glGetUniformBlockIndex(ID, blockName.c_str());
+        if (index != GL_INVALID_INDEX) glUniformBlockBinding(ID, index, binding);
+    }
+
+    // nor for samplers, whose unit is a uniform only settable on the program in use
+    int previous = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous);
+    for (const auto& [samplerName, unit] : samplerBindings) {
+        int location = glGetUniformLocation(ID, samplerName.c_str());
+        if (location < 0) continue;
+        glUseProgram(ID);
+        glUniform1i(location, unit);
+    }
+    glUseProgram(previous);
+}
+
+void Shader::setBlockBinding(const std::string& blockName, unsigned int binding) {
+    blockBindings[blockName] = binding;
+}
+
+void Shader::setSamplerBinding(const std::string& samplerName, int unit) {
+    samplerBindings[samplerName] = unit;
+}
+
+
 Shader::~Shader() {
+    workerBusy.wait(true, std::memory_order_acquire);              // never pull the program out from under the compile thread
+    if (vertexShader) glDeleteShader(vertexShader);
+    if (fragmentShader) glDeleteShader(fragmentShader);
     glDeleteProgram(ID);
 }
 void Shader::use() {
     glUseProgram(ID);
 }
 
-void Shader::setBool(const std::string &name, bool value) const {         
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+UniformHandle Shader::uniform(UniformId id) const {
+    auto it = std::lower_bound(uniforms.begin(), uniforms.end(), id.hash, [](const Uniform& u, uint32_t hash) { return u.hash < hash; });
+    if (it == uniforms.end() || it->hash != id.hash) return UniformHandle{};
+    return UniformHandle{(int)(it - uniforms.begin())};
+}
+
+// Returns the table entry if the handle is valid and the setter matches the declared GLSL type
+const Shader::Uniform* Shader::checked(UniformHandle handle, GLenum type, const char* setter) const {
+    if (!handle.valid()) return nullptr;                            // inactive uniforms are silently ignored, like location -1
+
+    const Uniform& u = uniforms[handle.index];
+    // the 0x8DC0-0x8DD8 sampler range has GL_UNSIGNED_INT_VEC2/3/4 (0x8DC6-0x8DC8) in the middle of it
+    bool sampler = (u.type >= GL_SAMPLER_1D && u.type <= GL_SAMPLER_2D_RECT_SHADOW) ||
+                   (u.type >= GL_SAMPLER_1D_ARRAY && u.type <= GL_SAMPLER_CUBE_SHADOW) ||
+                   (u.type >= GL_INT_SAMPLER_1D && u.type <= GL_UNSIGNED_INT_SAMPLER_BUFFER) ||
+                   (u.type >= GL_SAMPLER_2D_MULTISAMPLE && u.type <= GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY);
+    if (u.type == type || (type == GL_INT && sampler) || (type == GL_INT && u.type == GL_BOOL)) return &u;
+
+    std::cout << "ERROR::SHADER::UNIFORM::TYPE_MISMATCH " << setter << " on uniform of type 0x" << std::hex << u.type << std::dec << std::endl;
+    return nullptr;
+}
+
+void Shader::setBool(UniformHandle handle, bool value) {
+    if (!checked(handle, GL_BOOL, "setBool")) return;
+    Uniform& u = uniforms[handle.index];
+    if (u.uploaded && u.shadow.i[0] == (int)value) return;
+    u.uploaded = true;
+    u.shadow.i[0] = (int)value;
+    glUniform1i(u.location, (int)value);
+}
+
+void Shader::setInt(UniformHandle handle, int value) {
+    if (!checked(handle, GL_INT, "setInt")) return;
+    Uniform& u = uniforms[handle.index];
+    if (u.uploaded && u.shadow.i[0] == value) return;
+    u.uploaded = true;
+    u.shadow.i[0] = value;
+    glUniform1i(u.location, value);
 }
 
-void Shader::setInt(const std::string &name, int value) const { 
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+void Shader::setFloat(UniformHandle handle, float value) {
+    if (!checked(handle, GL_FLOAT, "setFloat")) return;
+    Uniform& u = uniforms[handle.index];
+    if (u.uploaded && u.shadow.f[0] == value) return;
+    u.uploaded = true;
+    u.shadow.f[0] = value;
+    glUniform1f(u.location, value);
 }
 
-void Shader::setFloat(const std::string &name, float value) const { 
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+void Shader::setVec2(UniformHandle handle, float x, float y) {
+    if (!checked(handle, GL_FLOAT_VEC2, "setVec2")) return;
+    Uniform& u = uniforms[handle.index];
+    if (u.uploaded && u.shadow.f[0] == x && u.shadow.f[1] == y) return;
+    u.uploaded = true;
+    u.shadow.f[0] = x;
+    u.shadow.f[1] = y;
+    glUniform2f(u.location, x, y);
 }
 
-void Shader::setVec2(const std::string &name, float x, float y) const {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+// arrays are not shadowed, every call uploads `count` elements starting at element 0
+void Shader::setFloats(UniformHandle handle, const float* values, int count) {
+    const Uniform* u = checked(handle, GL_FLOAT, "setFloats");
+    if (!u) return;
+    glUniform1fv(u->location, std::min(count, (int)u->size), values);
 }
@@ -2,27 +2,146 @@
 #define SHADER_H
 
 #include <glad/glad.h> // include glad to get all the required OpenGL headers
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iostream>
-  
+
+#include "shader_preprocessor.h"
+
+
+// Compile-time hashed uniform name (FNV-1a), e.g. "iTime"_u
+struct UniformId {
+    uint32_t hash;
+};
+
+constexpr uint32_t hashName(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= (uint8_t)c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+constexpr UniformId operator""_u(const char* name, size_t length) {
+    return UniformId{hashName(std::string_view(name, length))};
+}
+
+// Index into a Shader's uniform table, resolve once and reuse every frame
+struct UniformHandle {
+    int index = -1;
+    bool valid() const { return index >= 0; }
+};
+
+
+class ShaderCompiler;
+
+enum class CompileMode {
+    Blocking,                                                       // compile and link inside the constructor
+    Async                                                           // return immediately, poll status() until Ready
+};
+
+enum class ShaderStatus {
+    Pending,
+    Ready,
+    Failed
+};
+
 
 class Shader {
-    std::string read_file(const char* filename);
+    // One entry per active uniform, filled once after linking
+    struct Uniform {
+        uint32_t hash;                                              // hashName() of the uniform name (without "[0]")
+        GLint location;
+        GLenum type;                                                // GL_FLOAT, GL_FLOAT_VEC2, GL_BOOL... etc.
+        GLint size;                                                 // array length, 1 for non-arrays
+        bool uploaded;                                              // false until the first upload, shadow is garbage before that
+        union { float f[4]; int i[4]; } shadow;                     // last value sent to the driver
+    };
+
+    std::vector<Uniform> uniforms;                                  // sorted by hash
+    ShaderStatus state = ShaderStatus::Pending;
+    std::atomic<bool> workerBusy = false;                           // true while backgroundCompiler owns the program
+    unsigned int vertexShader = 0, fragmentShader = 0;              // alive until the compile is finished
+    uint64_t binaryKey = 0;
+
+    static std::map<std::string, unsigned int> blockBindings;       // uniform block name -> binding point
+    static std::map<std::string, int> samplerBindings;              // sampler uniform name -> texture unit
+
+    std::vector<std::string> vertexFiles, fragmentFiles;            // every source file of each stage, index = #line source number
+
+    static std::string describe_sources(const std::vector<std::string>& files);
+    void start_compile(const std::string& vertexCode, const std::string& fragmentCode);
+    void finish_compile();
+
+    // program binary cache
+    static uint64_t binary_key(const std::string& vertexCode, const std::string& fragmentCode);
+    static std::filesystem::path binary_path(uint64_t key);
+    bool load_binary(uint64_t key);
+    void save_binary(uint64_t key);
+
+    void load_uniforms();
+    const Uniform* checked(UniformHandle handle, GLenum type, const char* setter) const;
 
 public:
-    unsigned int ID;                                                // shader program ID
-  
-    Shader(const char* vertexPath, const char* fragmentPath);
+    unsigned int ID = 0;                                            // shader program ID
+
+    // where linked program binaries are cached between runs, empty disables the cache.
+    // Defaults to shader_cache/ next to the executable, or $SHADER_CACHE_DIR when set
+    static std::string cacheDirectory;
+
+    // worker with a shared context for CompileMode::Async, used when the driver can't compile in parallel itself
+    static ShaderCompiler* backgroundCompiler;
+
+    // every program declaring this uniform block gets it bound to `binding` after linking
+    static void setBlockBinding(const std::string& blockName, unsigned int binding);
+
+    // every program declaring this sampler uniform reads texture unit `unit` (set once after linking)
+    static void setSamplerBinding(const std::string& samplerName, int unit);
+
+    Shader(const char* vertexPath, const char* fragmentPath, CompileMode mode = CompileMode::Blocking, const ShaderDefines& defines = {});
     ~Shader();
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
+    // canonical "NAME=VALUE;..." string identifying a permutation
+    static std::string permutationKey(const ShaderDefines& defines);
+
+    std::vector<std::string> dependencies() const;                  // files this program was built from, includes too
+
+    ShaderStatus status();                                          // non-blocking, finishes the program once the driver is done
+    ShaderStatus wait();                                            // blocks until the program is no longer Pending
     void use();                                                     // use/activate the shader
-    
+
+    // resolve a uniform, returns an invalid handle if it is not active in this program
+    UniformHandle uniform(UniformId id) const;
+    UniformHandle uniform(std::string_view name) const { return uniform(UniformId{hashName(name)}); }
+
+    // typed uniform setters, the shader must be in use; unchanged values are not re-uploaded
+    void setBool(UniformHandle handle, bool value);
+    void setInt(UniformHandle handle, int value);
+    void setFloat(UniformHandle handle, float value);
+    void setVec2(UniformHandle handle, float x, float y);
+    void setFloats(UniformHandle handle, const float* values, int count);   // float array uniform
+
+    void setBool(UniformId id, bool value) { setBool(uniform(id), value); }
+    void setInt(UniformId id, int value) { setInt(uniform(id), value); }
+    void setFloat(UniformId id, float value) { setFloat(uniform(id), value); }
+    void setVec2(UniformId id, float x, float y) { setVec2(uniform(id), x, y); }
+    void setFloats(UniformId id, const float* values, int count) { setFloats(uniform(id), values, count); }
+
     // utility functions for uniform vars
-    void setBool(const std::string &name, bool value) const;  
-    void setInt(const std::string &name, int value) const;   
-    void setFloat(const std::string &name, float value) const;
-    void setVec2(const std::string &name, float x, float y) const;
+    void setBool(const std::string &name, bool value) { setBool(uniform(name), value); }
+    void setInt(const std::string &name, int value) { setInt(uniform(name), value); }
+    void setFloat(const std::string &name, float value) { setFloat(uniform(name), value); }
+    void setVec2(const std::string &name, float x, float y) { setVec2(uniform(name), x, y); }
 };
-  
+
 #endif
@@ -0,0 +1,40 @@
+#include "shader_compiler.h"
+
+ShaderCompiler::ShaderCompiler(std::function<void()> bindContext, std::function<void()> releaseContext) {
+    worker = std::thread(&ShaderCompiler::run, this, std::move(bindContext), std::move(releaseContext));
+}
+
+ShaderCompiler::~ShaderCompiler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void ShaderCompiler::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void ShaderCompiler::run(std::function<void()> bindContext, std::function<void()> releaseContext) {
+    bindContext();
+
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) break;                                // only reached when stopping
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+
+    releaseContext();
+}
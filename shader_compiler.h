@@ -0,0 +1,33 @@
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+// Background thread that owns a GL context sharing objects with the main one.
+// Used for asynchronous shader compilation when the driver lacks GL_KHR_parallel_shader_compile.
+class ShaderCompiler {
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::function<void()>> jobs;                         // run in FIFO order
+    bool stopping = false;
+
+    void run(std::function<void()> bindContext, std::function<void()> releaseContext);
+
+public:
+    // bindContext/releaseContext are called on the worker thread, before the first and after the last job
+    ShaderCompiler(std::function<void()> bindContext, std::function<void()> releaseContext);
+    ~ShaderCompiler();                                              // finishes queued jobs, then joins
+
+    ShaderCompiler(const ShaderCompiler&) = delete;
+    ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+    void submit(std::function<void()> job);
+};
+
+#endif
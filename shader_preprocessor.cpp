@@ -0,0 +1,187 @@
+#include "shader_preprocessor.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+#include "embedded_shaders.h"
+
+
+std::unordered_map<std::string, ShaderPreprocessor::ParsedFile> ShaderPreprocessor::cache;
+std::string ShaderPreprocessor::includeDirectory = "shaders";
+bool ShaderPreprocessor::readFromDisk = false;
+
+
+static const EmbeddedShader* findEmbedded(std::string_view path) {
+    const EmbeddedShader* end = embeddedShaders + embeddedShaderCount;
+    const EmbeddedShader* it = std::lower_bound(embeddedShaders, end, path, [](const EmbeddedShader& e, std::string_view p) { return e.path < p; });
+    return it != end && it->path == path ? it : nullptr;
+}
+
+// Embedded sources are used in place, files read from disk land in `storage`
+bool ShaderPreprocessor::read(const std::string& path, std::string& storage, std::string_view& source) {
+    if (!readFromDisk) {
+        if (const EmbeddedShader* embedded = findEmbedded(path)) {
+            source = embedded->source;
+            return true;
+        }
+    }
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+
+    storage.resize((size_t)in.tellg());
+    in.seekg(0);
+    in.read(storage.data(), storage.size());
+    source = storage;
+    return (bool)in;
+}
+
+bool ShaderPreprocessor::exists(const std::string& path) {
+    if (!readFromDisk && findEmbedded(normalize(path))) return true;
+    return std::filesystem::exists(path);
+}
+
+std::vector<std::string> ShaderPreprocessor::list(const std::string& directory, const std::string& extension) {
+    std::vector<std::string> paths;
+    std::filesystem::path dir = normalize(directory);
+
+    if (!readFromDisk) {
+        for (size_t i = 0; i < embeddedShaderCount; i++) {
+            std::filesystem::path path(embeddedShaders[i].path);
+            if (path.parent_path() == dir && path.extension() == extension) paths.push_back(path.generic_string());
+        }
+    }
+
+    if (paths.empty()) {
+        std::error_code error;
+        for (const auto& file : std::filesystem::directory_iterator(dir, error)) {
+            if (file.path().extension() == extension) paths.push_back(normalize(file.path().string()));
+        }
+    }
+
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+
+std::string ShaderPreprocessor::normalize(const std::string& path) {
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+void ShaderPreprocessor::invalidate(const std::string& path) {
+    cache.erase(normalize(path));
+}
+
+// Includes are looked up next to the including file first, then in includeDirectory
+std::string ShaderPreprocessor::resolve(const std::string& include, const std::string& from) {
+    std::filesystem::path local = std::filesystem::path(from).parent_path() / include;
+    if (exists(local.string())) return normalize(local.string());
+    return normalize((std::filesystem::path(includeDirectory) / include).string());
+}
+
+const ShaderPreprocessor::ParsedFile& ShaderPreprocessor::parse(const std::string& path) {
+    auto cached = cache.find(path);
+    if (cached != cache.end()) return cached->second;
+
+    ParsedFile& file = cache[path];
+
+    std::string storage;
+    std::string_view source;
+    if (!read(path, storage, source)) {
+        std::cout << "ERROR::SHADER::FAILED TO READ " << path << std::endl;
+        return file;
+    }
+    file.found = true;
+
+    int number = 0;
+    int conditionals = 0;                                           // #if/#ifdef/#ifndef blocks open at this line
+    Piece text{1, "", ""};
+    while (!source.empty()) {
+        size_t end = source.find('\n');
+        std::string_view line = source.substr(0, end);
+        source.remove_prefix(end == std::string_view::npos ? source.size() : end + 1);
+        number++;
+
+        size_t start = line.find_first_not_of(" \t");
+        std::string_view directive = start == std::string_view::npos ? std::string_view() : line.substr(start);
+
+        if (number == 1 && directive.starts_with("#version")) {
+            file.version = std::string(line);
+            text.line = 2;
+            continue;
+        }
+
+        // includes are expanded before the driver evaluates any condition, one inside #if would be pulled in regardless
+        std::string_view name = directive.starts_with("#") ? directive.substr(1) : std::string_view();
+        name.remove_prefix(std::min(name.size(), name.find_first_not_of(" \t")));
+        if (name.starts_with("if")) conditionals++;
+        else if (name.starts_with("endif")) conditionals = std::max(0, conditionals - 1);
+
+        bool include = name.starts_with("include");
+        if (include && conditionals > 0) {
+            std::cout << "ERROR::SHADER::INCLUDE::CONDITIONAL " << path << ":" << number
+                      << " includes are expanded unconditionally, move it out of the #if block" << std::endl;
+            text.text += '\n';                                      // keeps the following lines numbered right
+            continue;
+        }
+
+        if (include) {
+            size_t open = line.find('"');
+            size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+            if (close == std::string_view::npos) {
+                std::cout << "ERROR::SHADER::INCLUDE::MALFORMED " << path << ":" << number << std::endl;
+                text.text += '\n';
+                continue;
+            }
+
+            if (!text.text.empty()) file.pieces.push_back(text);
+            file.pieces.push_back(Piece{number, "", resolve(std::string(line.substr(open + 1, close - open - 1)), path)});
+            text = Piece{number + 1, "", ""};
+            continue;
+        }
+
+        text.text += line;
+        text.text += '\n';
+    }
+    if (!text.text.empty()) file.pieces.push_back(text);
+
+    return file;
+}
+
+ShaderPreprocessor::Result ShaderPreprocessor::process(const std::string& path, const ShaderDefines& defines) {
+    Result result;
+    std::set<std::string> included;
+
+    // depth-first expansion, each file's source number is its index in result.files
+    auto expand = [&](auto& self, const std::string& filePath) -> void {
+        int sourceNumber = (int)result.files.size();
+        result.files.push_back(filePath);
+        included.insert(filePath);
+
+        const ParsedFile& file = parse(filePath);
+        std::string resume = " " + std::to_string(sourceNumber) + "\n";
+
+        // #version must stay first, the permutation defines follow it
+        if (sourceNumber == 0) {
+            if (!file.version.empty()) result.source += file.version + "\n";
+            for (const auto& [name, value] : defines) result.source += "#define " + name + " " + value + "\n";
+        } else if (!file.version.empty()) {
+            std::cout << "WARNING::SHADER::INCLUDE::VERSION_IGNORED " << filePath << std::endl;
+        }
+
+        for (const Piece& piece : file.pieces) {
+            if (piece.include.empty()) {
+                result.source += "#line " + std::to_string(piece.line) + resume;
+                result.source += piece.text;
+            } else if (!included.count(piece.include)) {
+                self(self, piece.include);
+            }
+        }
+    };
+
+    expand(expand, normalize(path));
+    return result;
+}
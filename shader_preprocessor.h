@@ -0,0 +1,61 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <map>
+#include <string_view>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// Preprocessor defines injected after #version, one compiled program per distinct set
+using ShaderDefines = std::map<std::string, std::string>;
+
+
+// Expands `#include "file"` in GLSL sources before they are handed to the driver.
+// Files come from the copies embedded at build time (embedded_shaders.h) unless readFromDisk is set.
+// Every file is included at most once per program, and parsed files are kept in memory across programs.
+// Includes must not be conditional: one inside an #if/#ifdef/#ifndef block is reported and dropped, since it would
+// otherwise be expanded whatever the condition (put the #if inside the included file instead).
+// `#line <line> <source>` directives keep driver errors pointing at the right file: <source> indexes Result::files.
+class ShaderPreprocessor {
+    struct Piece {
+        int line;                                                   // line number of the first line in `text`, or of the #include
+        std::string text;                                           // verbatim lines, empty for an #include
+        std::string include;                                        // resolved path of an #include, empty for text
+    };
+
+    struct ParsedFile {
+        bool found = false;
+        std::string version;                                        // "#version ..." if it is the first line
+        std::vector<Piece> pieces;
+    };
+
+    static std::unordered_map<std::string, ParsedFile> cache;       // normalized path -> parsed file
+
+    static const ParsedFile& parse(const std::string& path);
+    static std::string resolve(const std::string& include, const std::string& from);
+    static bool read(const std::string& path, std::string& storage, std::string_view& source);
+
+public:
+    struct Result {
+        std::string source;                                         // ready for glShaderSource
+        std::vector<std::string> files;                             // every file pulled in, the main file first
+    };
+
+    // searched for includes that are not found next to the including file
+    static std::string includeDirectory;
+
+    // read shaders/ from disk instead of the embedded copies, for editing shaders without rebuilding
+    static bool readFromDisk;
+
+    static Result process(const std::string& path, const ShaderDefines& defines = {});
+
+    static bool exists(const std::string& path);
+    static std::vector<std::string> list(const std::string& directory, const std::string& extension);   // sorted paths
+
+    static std::string normalize(const std::string& path);
+    static void invalidate(const std::string& path);                // drop a cached parse after the file changed
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "shader_registry.h"
+
+#include <algorithm>
+#include <filesystem>
+
+
+ShaderRegistry::ShaderRegistry(const std::string& vertexPath, const std::string& directory, const std::vector<std::string>& order,
+                               const std::vector<ShaderDefines>& permutations)
+    : vertexPath(vertexPath), permutations(permutations) {
+
+    // embedded copies unless ShaderPreprocessor::readFromDisk
+    for (const std::string& path : ShaderPreprocessor::list(directory, ".frag")) {
+        entries.push_back(Entry{std::filesystem::path(path).stem().string(), path, {}});
+        entries.back().variants.resize(permutations.size());
+    }
+
+    // rank by position in `order`, unlisted names sort after it by name
+    auto rank = [&order](const Entry& e) {
+        return (size_t)(std::find(order.begin(), order.end(), e.name) - order.begin());
+    };
+    std::sort(entries.begin(), entries.end(), [&rank](const Entry& a, const Entry& b) {
+        size_t ra = rank(a), rb = rank(b);
+        return ra != rb ? ra < rb : a.name < b.name;
+    });
+}
+
+size_t ShaderRegistry::find(const std::string& name) const {
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].name == name) return i;
+    }
+    return entries.size();
+}
+
+Shader* ShaderRegistry::get(size_t index, size_t permutation) {
+    std::unique_ptr<Shader>& shader = entries[index].variants[permutation].shader;
+    if (!shader) shader = std::make_unique<Shader>(vertexPath.c_str(), entries[index].fragmentPath.c_str(), CompileMode::Async, permutations[permutation]);
+    return shader.get();
+}
+
+// Background compiles only start once the active program is usable, and only one at a time,
+// so prewarming never delays what is on screen. The active entry's other permutations go first,
+// so toggling a define swaps to a program that is already compiled.
+void ShaderRegistry::prewarm(size_t active) {
+    for (const Entry& entry : entries) {
+        for (const Variant& variant : entry.variants) {
+            if (variant.shader && variant.shader->status() == ShaderStatus::Pending) return;
+        }
+    }
+
+    auto next = [this](size_t index) {
+        for (size_t p = 0; p < permutations.size(); p++) {
+            if (!entries[index].variants[p].shader) {
+                get(index, p);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    if (next(active)) return;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (next(i)) return;
+    }
+}
+
+bool ShaderRegistry::busy() {
+    for (const Entry& entry : entries) {
+        for (const Variant& variant : entry.variants) {
+            if (!variant.shader || variant.shader->status() == ShaderStatus::Pending || variant.reloading) return true;
+        }
+    }
+    return false;
+}
+
+void ShaderRegistry::reload(const std::vector<std::string>& changed) {
+    if (changed.empty()) return;
+    for (const std::string& path : changed) ShaderPreprocessor::invalidate(path);
+
+    for (Entry& entry : entries) {
+        for (size_t p = 0; p < permutations.size(); p++) {
+            Variant& variant = entry.variants[p];
+            if (!variant.shader) continue;
+
+            std::vector<std::string> dependencies = variant.shader->dependencies();
+            if (variant.reloading) {                                // the newer sources may include other files
+                std::vector<std::string> pending = variant.reloading->dependencies();
+                dependencies.insert(dependencies.end(), pending.begin(), pending.end());
+            }
+            bool affected = std::any_of(changed.begin(), changed.end(), [&dependencies](const std::string& path) {
+                return std::find(dependencies.begin(), dependencies.end(), path) != dependencies.end();
+            });
+            if (!affected) continue;
+
+            if (variant.reloading) variant.dirty = true;
+            else startReload(entry, p);
+        }
+    }
+}
+
+void ShaderRegistry::startReload(Entry& entry, size_t permutation) {
+    std::string key = Shader::permutationKey(permutations[permutation]);
+    std::cout << "Reloading " << entry.name << (key.empty() ? "" : " [" + key + "]") << std::endl;
+    entry.variants[permutation].reloading = std::make_unique<Shader>(vertexPath.c_str(), entry.fragmentPath.c_str(), CompileMode::Async,
+                                                                     permutations[permutation]);
+    entry.variants[permutation].dirty = false;
+}
+
+void ShaderRegistry::update() {
+    for (Entry& entry : entries) {
+        for (size_t p = 0; p < entry.variants.size(); p++) {
+            Variant& variant = entry.variants[p];
+            if (!variant.reloading) continue;
+
+            ShaderStatus status = variant.reloading->status();
+            if (status == ShaderStatus::Ready) {
+                variant.shader = std::move(variant.reloading);
+            } else if (status == ShaderStatus::Failed) {
+                std::cout << "Reload of " << entry.name << " failed, keeping the previous program" << std::endl;
+                variant.reloading.reset();
+            } else {
+                continue;
+            }
+
+            if (variant.dirty) startReload(entry, p);               // saved again while that one compiled
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef SHADER_REGISTRY_H
+#define SHADER_REGISTRY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "shader.h"
+
+
+// Rendering programs discovered on disk, each compiled the first time it is needed
+class ShaderRegistry {
+    struct Variant {
+        std::unique_ptr<Shader> shader;                             // null until first use or prewarm
+        std::unique_ptr<Shader> reloading;                          // replacement being compiled after a source change
+        bool dirty = false;                                         // sources changed again during that compile, rebuild once it is done
+    };
+
+    struct Entry {
+        std::string name;                                           // file stem, e.g. "raytrace"
+        std::string fragmentPath;
+        std::vector<Variant> variants;                              // one per permutation
+    };
+
+    std::string vertexPath;
+    std::vector<ShaderDefines> permutations;
+    std::vector<Entry> entries;
+
+    void startReload(Entry& entry, size_t permutation);
+
+public:
+    // finds every .frag in `directory` (embedded or on disk); names listed in `order` come first, the rest follow alphabetically.
+    // each program is built once per entry of `permutations`, selected by index in get()
+    ShaderRegistry(const std::string& vertexPath, const std::string& directory, const std::vector<std::string>& order = {},
+                   const std::vector<ShaderDefines>& permutations = {{}});
+
+    size_t size() const { return entries.size(); }
+    const std::string& name(size_t index) const { return entries[index].name; }
+    size_t find(const std::string& name) const;                     // index of the entry, size() if there is none
+
+    Shader* get(size_t index, size_t permutation = 0);              // starts an async compile on first use
+    void prewarm(size_t active);                                    // call once per frame, compiles one idle variant at a time
+    bool busy();                                                    // true while prewarm() or reload() still have work to finish
+
+    // recompile every program built from one of `changed` files, the old program stays live until the new one is Ready.
+    // A program already being recompiled is left to finish (destroying it would wait for the compile), update() then
+    // starts one more rebuild with the latest sources
+    void reload(const std::vector<std::string>& changed);
+    void update();                                                  // call once per frame between draws, swaps in finished reloads
+};
+
+#endif
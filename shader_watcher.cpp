@@ -0,0 +1,108 @@
+#include "shader_watcher.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "shader_preprocessor.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef __linux__
+
+ShaderWatcher::ShaderWatcher(const std::string& directory) : directory(directory) {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cout << "ERROR::SHADER_WATCHER::INOTIFY_INIT_FAILED" << std::endl;
+        return;
+    }
+    add_watches();
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    if (fd >= 0) close(fd);
+}
+
+// inotify is not recursive, every directory gets its own watch
+void ShaderWatcher::add_watches() {
+    // editors often save by writing a new file and renaming it over the old one, hence IN_MOVED_TO
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    std::vector<std::string> directories = {directory};
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, error)) {
+        if (entry.is_directory()) directories.push_back(entry.path().string());
+    }
+
+    for (const std::string& dir : directories) {
+        int wd = inotify_add_watch(fd, dir.c_str(), mask);
+        if (wd >= 0) watches[wd] = dir;
+    }
+}
+
+std::vector<std::string> ShaderWatcher::poll() {
+    std::vector<std::string> changed;
+    if (fd < 0) return changed;
+
+    alignas(inotify_event) char buffer[4096];
+    bool newDirectory = false;
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + length; p += sizeof(inotify_event) + ((inotify_event*)p)->len) {
+            const inotify_event* event = (const inotify_event*)p;
+            auto watch = watches.find(event->wd);
+            if (watch == watches.end() || event->len == 0) continue;
+
+            if (event->mask & IN_ISDIR) {
+                newDirectory = true;
+                continue;
+            }
+            if (event->mask & IN_CREATE) continue;                  // wait for the IN_CLOSE_WRITE that follows
+
+            std::string path = ShaderPreprocessor::normalize(watch->second + "/" + event->name);
+            if (std::find(changed.begin(), changed.end(), path) == changed.end()) changed.push_back(path);
+        }
+    }
+
+    if (newDirectory) add_watches();                                // re-adding an existing watch is harmless
+    return changed;
+}
+
+#else
+
+ShaderWatcher::ShaderWatcher(const std::string& directory) : directory(directory) {
+    scan(nullptr);
+}
+
+ShaderWatcher::~ShaderWatcher() {}
+
+void ShaderWatcher::scan(std::vector<std::string>* changed) {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, error)) {
+        if (!entry.is_regular_file()) continue;
+
+        std::string path = ShaderPreprocessor::normalize(entry.path().string());
+        auto time = entry.last_write_time(error);
+        auto known = times.find(path);
+        if (known != times.end() && known->second == time) continue;
+
+        if (changed) changed->push_back(path);
+        times[path] = time;
+    }
+}
+
+std::vector<std::string> ShaderWatcher::poll() {
+    std::vector<std::string> changed;
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastScan < std::chrono::milliseconds(250)) return changed;
+    lastScan = now;
+
+    scan(&changed);
+    return changed;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+
+// Reports files that changed under a directory tree, polled once per frame without blocking.
+// Uses inotify on Linux, elsewhere compares modification times a few times per second.
+class ShaderWatcher {
+    std::string directory;
+
+#ifdef __linux__
+    int fd = -1;
+    std::map<int, std::string> watches;                             // watch descriptor -> watched directory
+    void add_watches();
+#else
+    std::map<std::string, std::filesystem::file_time_type> times;
+    std::chrono::steady_clock::time_point lastScan;
+    void scan(std::vector<std::string>* changed);
+#endif
+
+public:
+    explicit ShaderWatcher(const std::string& directory);
+    ~ShaderWatcher();
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    std::vector<std::string> poll();                                // normalized paths (see ShaderPreprocessor::normalize)
+};
+
+#endif
@@ -0,0 +1,9 @@
+// Pinhole camera at z = -1 looking through the unit image plane at z = 0.
+// p is in [0, 1] screen space, iJitter moves the ray within its pixel for accumulation
+void cameraRay(vec2 p, out vec3 ro, out vec3 rd) {
+    p += iJitter / iResolution;
+    vec2 cp = p / 2.0 - vec2(0.5, 0.5);
+    vec3 pix = vec3(cp, 0.0);
+    ro = vec3(0.0, 0.0, -1.0);
+    rd = normalize(pix - ro);
+}
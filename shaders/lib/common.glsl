@@ -0,0 +1,30 @@
+// Shared declarations for every rendering shader, include first
+
+#ifndef CHECKERBOARD
+#define CHECKERBOARD 0                                              // shade half the pixels per frame, see checkerboard.h
+#endif
+
+precision highp float;
+
+layout(std140) uniform FrameConstants {                             // shared by all programs, see frame_constants.h
+    vec2 iResolution;
+    float iTime;
+    int iFrame;
+    vec2 iJitter;                                                   // subpixel offset of the camera ray, see camera.glsl
+    vec2 iTileOffset;                                               // where this render target sits in the iResolution image
+};
+
+const float PI = 3.1415926535897932384626433832795;
+
+// Full-resolution pixel shaded by this invocation, use instead of gl_FragCoord.xy.
+// With CHECKERBOARD the target is half as wide and row y holds the pixels where x + y + iFrame is even.
+// Tiles of a larger image add their offset, so the result is the pixel's position in the whole image
+vec2 pixelCoord() {
+#if CHECKERBOARD
+    int y = int(gl_FragCoord.y);
+    int x = int(gl_FragCoord.x) * 2 + ((y + iFrame) & 1);
+    return vec2(float(x) + 0.5, gl_FragCoord.y) + iTileOffset;
+#else
+    return gl_FragCoord.xy + iTileOffset;
+#endif
+}
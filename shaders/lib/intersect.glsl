@@ -0,0 +1,24 @@
+// Closest ray-sphere intersection in front of the ray origin
+bool intersect(vec3 ro, vec3 rd, vec3 center, float r, out vec3 p) {
+    float a = dot(rd, rd);
+    float b = 2.0 * dot(rd, ro - center);
+    float c = dot(ro - center, ro - center) - r * r;
+
+    float discriminant = b * b - 4.0 * a * c;
+    if (discriminant > 0.0) {
+        float t1 = (-b - sqrt(discriminant)) / (2.0 * a);
+        float t2 = (-b + sqrt(discriminant)) / (2.0 * a);
+        
+        if (t1 > 0.0 && t2 > 0.0) {
+            p = ro + min(t1, t2) * rd;
+            return true;
+        } else if (t1 > 0.0) {
+            p = ro + t1 * rd;
+            return true;
+        } else if (t2 > 0.0) {
+            p = ro + t2 * rd;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,14 @@
+#include "common.glsl"
+
+
+struct Light {
+    vec3 position;
+    float intensity;
+};
+
+// Irradiance at p with surface normal n from a point light
+float calcE(vec3 p, vec3 n, Light light) {
+    vec3 l = normalize(light.position - p);
+    float r = length(light.position - p);
+    return light.intensity * dot(n, l) / (4.0 * PI * r * r);
+}
@@ -0,0 +1,35 @@
+// Sphere marching against the scene SDF, the including shader defines funcImp()
+
+#ifndef MAX_STEPS
+#define MAX_STEPS 100                                               // sphere marching iterations
+#endif
+#ifndef HIT_EPSILON
+#define HIT_EPSILON 0.001                                           // distance treated as a surface hit
+#endif
+
+float funcImp(vec3 p);                                              // SDF of scene (implicit function)
+
+// Estimate normal based on finite differences
+vec3 calcNormal(vec3 p) {
+    const float eps = 0.001; 
+    const vec2 h = vec2(eps, 0);
+    return normalize(vec3(
+        funcImp(p+h.xyy) - funcImp(p-h.xyy),
+        funcImp(p+h.yxy) - funcImp(p-h.yxy),
+        funcImp(p+h.yyx) - funcImp(p-h.yyx)
+    ));
+}
+
+// March from ro along rd, p is the hit point (or where marching stopped)
+bool march(vec3 ro, vec3 rd, out vec3 p) {
+    p = ro;
+
+    for(int i = 0; i < MAX_STEPS; i++) {
+        float d = funcImp(p);                                       // distance to nearest surface
+        if (abs(d) <= HIT_EPSILON) {                                // if we've hit the surface (close enough)
+            return true;
+        }
+        p = p + rd * d;                                             // otherwise, move along the ray
+    }
+    return false;
+}
@@ -0,0 +1,25 @@
+// Spheres and point lights of the data-driven scene, uploaded by Scene (see scene.h)
+#include "lighting.glsl"
+
+layout(std140) uniform SceneConstants {
+    int sphereCount;
+    int lightCount;
+};
+
+uniform samplerBuffer sceneSpheres;                                 // xyz center, w radius
+uniform samplerBuffer sceneLights;                                  // xyz position, w intensity
+
+struct Ball {
+    vec3 center;
+    float radius;
+};
+
+Ball sceneSphere(int i) {
+    vec4 texel = texelFetch(sceneSpheres, i);
+    return Ball(texel.xyz, texel.w);
+}
+
+Light sceneLight(int i) {
+    vec4 texel = texelFetch(sceneLights, i);
+    return Light(texel.xyz, texel.w);
+}
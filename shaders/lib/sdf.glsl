@@ -0,0 +1,74 @@
+#include "transform.glsl"
+
+
+// SDF functions of common shapes--------------------------------
+// From https://iquilezles.org/articles/distfunctions/
+
+float funcSphere(vec3 p, vec3 centre, float radius) {
+    return length(p - centre) - radius;
+}
+
+float funcBox(vec3 p, vec3 b, vec3 pos, vec3 rot) {
+    p = translate(p, -pos); // inverse translation of box
+    p = rotateX(rot.x) * p;
+    p = rotateY(rot.y) * p;
+    p = rotateZ(rot.z) * p;
+
+    vec3 q = abs(p) - b;
+    return length(max(q,0.0)) + min(max(q.x,max(q.y,q.z)),0.0);
+}
+
+float funcBoxFrame( vec3 p, vec3 b, float e, vec3 pos, vec3 rot) {
+    p = translate(p, -pos); // inverse translation of box
+    p = rotateX(rot.x) * p;
+    p = rotateY(rot.y) * p;
+    p = rotateZ(rot.z) * p;
+
+    p = abs(p) - b;
+    vec3 q = abs(p + e) - e;
+
+    return min(min(
+        length(max(vec3(p.x,q.y,q.z),0.0))+min(max(p.x,max(q.y,q.z)),0.0),
+        length(max(vec3(q.x,p.y,q.z),0.0))+min(max(q.x,max(p.y,q.z)),0.0)),
+        length(max(vec3(q.x,q.y,p.z),0.0))+min(max(q.x,max(q.y,p.z)),0.0));
+}
+
+float funcCylinder(vec3 p, float r, float h, vec3 pos, vec3 rot) {
+    p = translate(p, -pos); // inverse translation of cylinder
+    p = rotateX(-rot.x) * p;
+    p = rotateY(-rot.y) * p;
+    p = rotateZ(-rot.z) * p;
+
+    vec2 d = abs(vec2(length(p.xz), p.y)) - vec2(r, h);
+    return min(max(d.x, d.y), 0.0) + length(max(d, 0.0));
+}
+
+float funcHexPrism( vec3 p, vec2 h, vec3 pos, vec3 rot ) {
+    p = translate(p, -pos); // inverse translation of hex prism
+    p = rotateX(-rot.x) * p;
+    p = rotateY(-rot.y) * p;
+    p = rotateZ(-rot.z) * p;
+
+    const vec3 k = vec3(-0.8660254, 0.5, 0.57735);
+    p = abs(p);
+    p.xy -= 2.0 * min(dot(k.xy, p.xy), 0.0) * k.xy;
+    vec2 d = vec2(length(p.xy - vec2(clamp(p.x, -k.z*h.x, k.z*h.x), h.x)) * sign(p.y-h.x), p.z - h.y);
+    return min(max(d.x, d.y), 0.0) + length(max(d, 0.0));
+}
+
+
+
+// Smooth union and subtraction functions --------------------------------
+// From https://iquilezles.org/articles/distfunctions/
+
+float smoothUnion(float d1, float d2, float k) {
+    k *= 4.0;
+    float h = max(k - abs(d1 - d2), 0.0);
+    return min(d1, d2) - h * h * 0.25/k;
+}
+
+float smoothSubtraction(float d1, float d2, float k) {
+    k *= 4.0;
+    float h = max(k - abs(d1 - d2), 0.0);
+    return max(d1, -d2) + h * h * 0.25/k;
+}
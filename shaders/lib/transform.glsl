@@ -0,0 +1,26 @@
+// Utility functions for rotating and translating --------------------------------
+mat3 rotateX(float angle) {
+    return mat3(1.0, 0.0, 0.0,
+        0.0, cos(angle), sin(angle),
+        0.0, -sin(angle), cos(angle));
+}
+
+mat3 rotateY(float angle) {
+    return mat3(cos(angle), 0.0, -sin(angle),
+        0.0, 1.0, 0.0,
+        sin(angle), 0.0, cos(angle));
+}
+
+mat3 rotateZ(float angle) {
+    return mat3(cos(angle), sin(angle), 0.0,
+        -sin(angle), cos(angle), 0.0,
+        0.0, 0.0, 1.0);
+}
+
+vec3 translate(vec3 p, vec3 t) {
+    mat4 m = mat4(1.0, 0.0, 0.0, 0.0,
+        0.0, 1.0, 0.0, 0.0,
+        0.0, 0.0, 1.0, 0.0,
+        t.x, t.y, t.z, 1.0);
+    return (m * vec4(p, 1.0)).xyz;
+}
@@ -0,0 +1,33 @@
+#version 330 core
+
+out vec4 FragColor;
+
+// Frame time bar graph drawn over the scene (see frame_profiler.h), one bar per frame, newest on the right
+
+#define SAMPLES 120
+
+uniform float frameTimes[SAMPLES];                                  // ms, oldest first
+uniform vec2 graphOrigin;                                           // lower-left corner of the graph viewport, in pixels
+uniform vec2 graphSize;
+uniform float graphScale;                                           // ms at the top of the graph
+
+const float BUDGET_60 = 1000.0 / 60.0;
+const float BUDGET_30 = 1000.0 / 30.0;
+
+void main() {
+    vec2 uv = (gl_FragCoord.xy - graphOrigin) / graphSize;
+    int bar = clamp(int(uv.x * float(SAMPLES)), 0, SAMPLES - 1);
+    float ms = uv.y * graphScale;
+
+    vec4 color = vec4(0.0, 0.0, 0.0, 0.5);                          // background
+    if (ms < frameTimes[bar]) {
+        float t = frameTimes[bar];
+        color = t > BUDGET_30 ? vec4(0.9, 0.2, 0.2, 0.9) : t > BUDGET_60 ? vec4(0.9, 0.8, 0.2, 0.9) : vec4(0.2, 0.8, 0.3, 0.9);
+    }
+
+    // budget lines for 60 and 30 fps
+    float pixel = graphScale / graphSize.y;
+    if (abs(ms - BUDGET_60) < pixel || abs(ms - BUDGET_30) < pixel) color = vec4(1.0, 1.0, 1.0, 0.8);
+
+    FragColor = color;
+}
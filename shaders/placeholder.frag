@@ -0,0 +1,12 @@
+#version 330 core
+
+out vec4 FragColor;
+
+#include "lib/common.glsl"
+
+// Shown while the selected program is still compiling: a dim pulsing gradient
+void main() {
+    vec2 uv = gl_FragCoord.xy / iResolution.xy;
+    float pulse = 0.5 + 0.5 * sin(iTime * 3.0);
+    FragColor = vec4(vec3(0.05 + 0.1 * uv.y * pulse), 1.0);
+}
@@ -0,0 +1,16 @@
+#version 330 core
+
+out vec4 FragColor;
+
+// One step of a running mean (see accumulator.h): history + (sample - history) / n
+
+uniform sampler2D sampleTexture;                                    // the frame just rendered
+uniform sampler2D historyTexture;                                   // mean of the previous samples
+uniform float weight;                                               // 1 / number of samples including this one
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 current = texelFetch(sampleTexture, pixel, 0);
+    vec4 history = texelFetch(historyTexture, pixel, 0);
+    FragColor = weight >= 1.0 ? current : mix(history, current, weight);     // history is undefined before the first sample
+}
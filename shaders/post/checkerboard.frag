@@ -0,0 +1,43 @@
+#version 330 core
+
+out vec4 FragColor;
+
+// Rebuilds the full frame from a half-width checkerboard render (see checkerboard.h).
+// Pixels shaded this frame are copied, the others come from the previous output clamped
+// to the range of their four freshly shaded neighbours, which limits ghosting on moving objects.
+
+#include "../lib/common.glsl"
+
+uniform sampler2D halfTexture;                                      // this frame's samples, (x / 2, y) holds pixel (x, y)
+uniform sampler2D historyTexture;                                   // previous full-resolution output
+uniform bool historyValid;                                          // false on the first frame, neighbours are averaged instead
+
+vec4 shaded(ivec2 p) {
+    ivec2 size = ivec2(iResolution);
+    p = clamp(p, ivec2(0), size - 1);
+    return texelFetch(halfTexture, ivec2(p.x / 2, p.y), 0);
+}
+
+void main() {
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    if (((p.x + p.y + iFrame) & 1) == 0) {
+        FragColor = shaded(p);
+        return;
+    }
+
+    // neighbours across a row edge are mirrored so they keep the shaded parity
+    ivec2 size = ivec2(iResolution);
+    vec4 l = shaded(ivec2(p.x > 0 ? p.x - 1 : p.x + 1, p.y));
+    vec4 r = shaded(ivec2(p.x < size.x - 1 ? p.x + 1 : p.x - 1, p.y));
+    vec4 d = shaded(ivec2(p.x, p.y > 0 ? p.y - 1 : p.y + 1));
+    vec4 u = shaded(ivec2(p.x, p.y < size.y - 1 ? p.y + 1 : p.y - 1));
+
+    if (!historyValid) {
+        FragColor = (l + r + d + u) * 0.25;
+        return;
+    }
+
+    vec4 lo = min(min(l, r), min(d, u));
+    vec4 hi = max(max(l, r), max(d, u));
+    FragColor = clamp(texelFetch(historyTexture, p, 0), lo, hi);
+}
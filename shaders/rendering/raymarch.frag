@@ -1,19 +1,20 @@
 #version 330 core
 
-precision highp float;
 out vec4 FragColor;
 
-uniform vec2 iResolution;
-uniform float iTime;
-uniform bool showLighting;
+// Permutation defines, injected by Shader after #version (see ShaderDefines)
+#ifndef LIGHTING
+#define LIGHTING 0                                                  // lambertian shading
+#endif
 
-const float PI = 3.1415926535897932384626433832795;
+#include "../lib/common.glsl"
+#include "../lib/sdf.glsl"
+#include "../lib/camera.glsl"
+#include "../lib/lighting.glsl"
+#include "../lib/raymarch.glsl"
 
+const Light light = Light(vec3(0.0, 15.0, 15.0), 30000.0);
 
-// SDF of a sphere
-float funcSphere(vec3 p, vec3 centre, float radius) {
-    return length(p - centre) - radius;
-}
 
 // SDF of scene (implicit function)
 float funcImp(vec3 p) {
@@ -22,62 +23,23 @@ float funcImp(vec3 p) {
     return min(f1, f2);
 }
 
-// Estimate normal based on finite differences
-vec3 calcNormal(vec3 p) {
-    const float eps = 0.001; 
-    const vec2 h = vec2(eps, 0);
-    return normalize(vec3(
-        funcImp(p+h.xyy) - funcImp(p-h.xyy),
-        funcImp(p+h.yxy) - funcImp(p-h.yxy),
-        funcImp(p+h.yyx) - funcImp(p-h.yyx)
-    ));
-}
-
-void cameraRay(vec2 p, out vec3 ro, out vec3 rd) {
-    vec2 cp = p / 2.0 - vec2(0.5, 0.5);
-    vec3 pix = vec3(cp, 0.0);
-    ro = vec3(0.0, 0.0, -1.0);
-    rd = normalize(pix - ro);
-}
-
-float calcE(vec3 p, vec3 n) {
-    vec3 lightOrigin = vec3(0.0, 15.0, 15.0);
-    float intensity = 30000.0;
-
-    vec3 l = normalize(lightOrigin - p);
-    float r = length(lightOrigin - p);
-    return intensity * dot(n, l) / (4.0 * PI * r * r);
-}
-
 
 void main() {
 
     // Generate a camera ray --------------------------------
-    vec2 uv = gl_FragCoord.xy / iResolution.xy;
+    vec2 uv = pixelCoord() / iResolution.xy;
     vec3 ro, rd;
     cameraRay(uv, ro, rd); 
     
     // Ray marching (sphere marching) --------------------------------
-    int max_steps = 100;
-    bool hit = false;
-    vec3 p = ro;
-
-    for(int i = 0; i < max_steps; i++) {
-        float d = funcImp(p);                                       // distance to nearest surface
-        if (abs(d) <= 0.001) {                                      // if we've hit the surface (close enough)
-            hit = true;
-            break;
-        }
-        p = p + rd * d;                                            // otherwise, move along the ray
-    }
-
-    if (hit) {
+    vec3 p;
+    if (march(ro, rd, p)) {
         vec3 n = calcNormal(p);
         float c = 1.0;
-        if (showLighting) {
-            float Kd = 1.0;
-            c = Kd / PI * calcE(p, n);                  // lambertian shading
-        }
+#if LIGHTING
+        float Kd = 1.0;
+        c = Kd / PI * calcE(p, n, light);                           // lambertian shading
+#endif
 
         FragColor = vec4(c * abs(vec3(n.z, n.x, n.y)), 1.0);
 
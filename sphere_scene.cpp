@@ -0,0 +1,38 @@
+#include "sphere_scene.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+SphereScene::SphereScene(int count) : fieldSize(std::max(count, 0)) {
+    animate(0.0f);
+}
+
+void SphereScene::animate(float time) {
+    if (fieldSize == 0) {
+        spheres = {
+            {{std::sin(time / 2.0f) * 5.0f, 0.0f, 40.0f}, 5.0f},
+            {{std::sin(time / 2.0f) * 5.0f + std::sin(time / 0.5f) * 5.0f, 4.5f, 40.0f + std::cos(time / 0.5f) * 4.0f}, 2.5f},
+        };
+        lights = {{{0.0f, 15.0f, 15.0f}, 30000.0f}};
+        return;
+    }
+
+    // columns x rows grid on the plane y = -6, from 20 to 100 units in front of the camera
+    int columns = (int)std::ceil(std::sqrt((float)fieldSize));
+    int rows = (fieldSize + columns - 1) / columns;
+    float spacing = 80.0f / (float)std::max(rows, columns);
+    float radius = spacing * 0.4f;
+
+    spheres.resize(fieldSize);
+    for (int i = 0; i < fieldSize; i++) {
+        float x = ((float)(i % columns) - (float)(columns - 1) * 0.5f) * spacing;
+        float z = 20.0f + (float)(i / columns) * spacing;
+        float y = -6.0f + std::sin(time * 2.0f + x * 0.3f + z * 0.2f) * 1.5f;         // travelling wave
+        spheres[i] = {{x, y, z}, radius};
+    }
+    lights = {
+        {{0.0f, 15.0f, 15.0f}, 30000.0f},
+        {{std::sin(time / 2.0f) * 30.0f, 20.0f, 60.0f}, 60000.0f},
+    };
+}
@@ -0,0 +1,37 @@
+#ifndef SPHERE_SCENE_H
+#define SPHERE_SCENE_H
+
+#include <vector>
+
+
+// One RGBA32F texel each in the texture buffers read by raytrace.frag (see scene.h)
+struct SceneSphere {
+    float center[3];
+    float radius;
+};
+
+struct SceneLight {
+    float position[3];
+    float intensity;                                                // radiant power, as Light in lighting.glsl
+};
+
+static_assert(sizeof(SceneSphere) == 16 && sizeof(SceneLight) == 16, "must match one RGBA32F texel");
+
+
+// Spheres and point lights drawn by raytrace.frag, animated on the CPU and shared by the GPU upload and the
+// CPU port so both render the same positions.
+// The default scene is the two balls and one light raytrace.frag always had; SphereScene(N) is a field of N
+// spheres on a grid under the camera, rippling with time, lit by two lights.
+class SphereScene {
+    int fieldSize;                                                  // 0 for the default scene
+
+public:
+    std::vector<SceneSphere> spheres;
+    std::vector<SceneLight> lights;
+
+    explicit SphereScene(int count = 0);
+
+    void animate(float time);                                       // positions at iTime = time
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include "tile_scheduler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+
+// interleaves the bits of x and y, tiles sorted by it follow the Z-order curve
+static uint32_t morton(uint32_t x, uint32_t y) {
+    auto spread = [](uint32_t v) {
+        v &= 0xFFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+static double milliseconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+
+TileScheduler::TileScheduler(size_t threads, bool pin) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    queues = std::make_unique<Queue[]>(threads);
+    for (size_t i = 0; i < threads; i++) workers.emplace_back(&TileScheduler::work, this, i, pin);
+}
+
+TileScheduler::~TileScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void TileScheduler::run(int width, int height, const std::function<void(const Tile&)>& tileBody) {
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesY = (height + tileSize - 1) / tileSize;
+
+    std::vector<std::pair<uint32_t, Tile>> ordered;
+    ordered.reserve((size_t)tilesX * tilesY);
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            int left = tx * tileSize, top = ty * tileSize;
+            ordered.push_back({morton(tx, ty), {left, top, std::min(left + tileSize, width), std::min(top + tileSize, height)}});
+        }
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tiles.clear();
+        for (const auto& entry : ordered) tiles.push_back(entry.second);
+        tileRecords.assign(tiles.size(), {});
+
+        // worker i starts with the i-th contiguous run of the curve
+        size_t count = tiles.size(), threads = workers.size();
+        for (size_t i = 0; i < threads; i++) {
+            uint64_t begin = count * i / threads, end = count * (i + 1) / threads;
+            queues[i].range = begin | (end << 32);
+        }
+
+        body = &tileBody;
+        running = threads;
+        generation++;
+        runStart = std::chrono::steady_clock::now();
+    }
+    wake.notify_all();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return running == 0; });
+    body = nullptr;
+    runMs = milliseconds(std::chrono::steady_clock::now() - runStart);
+}
+
+bool TileScheduler::pop(size_t queue, bool back, uint32_t& index) {
+    std::atomic<uint64_t>& range = queues[queue].range;
+    uint64_t current = range.load(std::memory_order_relaxed);
+    while (true) {
+        uint32_t begin = (uint32_t)current, end = (uint32_t)(current >> 32);
+        if (begin >= end) return false;
+
+        uint64_t next = back ? begin | ((uint64_t)(end - 1) << 32) : (begin + 1) | ((uint64_t)end << 32);
+        if (range.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+            index = back ? end - 1 : begin;
+            return true;
+        }
+    }
+}
+
+void TileScheduler::work(size_t thread, bool pin) {
+#ifdef __linux__
+    if (pin) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(thread % std::max(1u, std::thread::hardware_concurrency()), &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            std::cout << "ERROR::TILE_SCHEDULER::FAILED TO PIN worker " << thread << std::endl;
+        }
+    }
+#else
+    (void)pin;
+#endif
+
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        size_t threads = workers.size();
+        uint32_t index;
+        while (true) {
+            bool stolen = false;
+            if (!pop(thread, false, index)) {
+                // own run is done, steal the far end of the next worker's that still has tiles
+                for (size_t k = 1; k < threads && !stolen; k++) stolen = pop((thread + k) % threads, true, index);
+                if (!stolen) break;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            (*body)(tiles[index]);
+            auto end = std::chrono::steady_clock::now();
+            tileRecords[index] = {tiles[index], (int)thread, stolen, milliseconds(start - runStart), milliseconds(end - start)};
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--running == 0) done.notify_one();
+    }
+}
+
+std::string TileScheduler::summary() const {
+    std::vector<double> busy(workers.size(), 0.0);
+    int stolen = 0;
+    for (const TileRecord& r : tileRecords) {
+        busy[r.thread] += r.ms;
+        stolen += r.stolen;
+    }
+
+    double total = 0.0, lowest = busy.empty() ? 0.0 : busy[0];
+    for (double b : busy) {
+        total += b;
+        lowest = std::min(lowest, b);
+    }
+    double capacity = runMs > 0.0 ? runMs : 1.0;
+
+    char line[160];
+    snprintf(line, sizeof(line), "%zu tiles in %.1f ms on %zu thread(s), %d stolen, %.0f%% busy (least busy thread %.0f%%)",
+             tileRecords.size(), runMs, workers.size(), stolen, 100.0 * total / (capacity * workers.size()), 100.0 * lowest / capacity);
+    return line;
+}
+
+bool TileScheduler::writeCSV(const std::string& path) const {
+    std::ofstream out(path);
+    out << "order,left,top,width,height,thread,stolen,start_ms,ms\n";
+    for (size_t i = 0; i < tileRecords.size(); i++) {
+        const TileRecord& r = tileRecords[i];
+        out << i << "," << r.tile.left << "," << r.tile.top << "," << r.tile.right - r.tile.left << "," << r.tile.bottom - r.tile.top
+            << "," << r.thread << "," << (r.stolen ? 1 : 0) << "," << r.startMs << "," << r.ms << "\n";
+    }
+    return (bool)out;
+}
+
+bool TileScheduler::writeJSON(const std::string& path) const {
+    std::vector<double> busy(workers.size(), 0.0);
+    std::vector<int> count(workers.size(), 0), stolen(workers.size(), 0);
+    for (const TileRecord& r : tileRecords) {
+        busy[r.thread] += r.ms;
+        count[r.thread]++;
+        stolen[r.thread] += r.stolen;
+    }
+
+    std::ofstream out(path);
+    out << "{\n  \"ms\": " << runMs << ",\n  \"tile_size\": " << tileSize << ",\n  \"threads\": [\n";
+    for (size_t t = 0; t < workers.size(); t++) {
+        out << "    {\"thread\": " << t << ", \"tiles\": " << count[t] << ", \"stolen\": " << stolen[t] << ", \"busy_ms\": " << busy[t] << "}"
+            << (t + 1 < workers.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"tiles\": [\n";
+    for (size_t i = 0; i < tileRecords.size(); i++) {
+        const TileRecord& r = tileRecords[i];
+        out << "    {\"left\": " << r.tile.left << ", \"top\": " << r.tile.top << ", \"width\": " << r.tile.right - r.tile.left
+            << ", \"height\": " << r.tile.bottom - r.tile.top << ", \"thread\": " << r.thread << ", \"stolen\": " << (r.stolen ? "true" : "false")
+            << ", \"start_ms\": " << r.startMs << ", \"ms\": " << r.ms << "}" << (i + 1 < tileRecords.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+bool TileScheduler::write(const std::string& path) const {
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    bool ok = json ? writeJSON(path) : writeCSV(path);
+    if (ok) std::cout << "Wrote tile timings to " << path << std::endl;
+    else std::cout << "ERROR::TILE_SCHEDULER::FAILED TO WRITE " << path << std::endl;
+    return ok;
+}
@@ -0,0 +1,80 @@
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Work-stealing tile scheduler shared by the CPU renderers (cpu_raytracer.h, cpu_raymarcher.h).
+// The image is cut into tileSize squares, ordered along a Morton (Z-order) curve so consecutive tiles are close
+// together in the framebuffer, and each thread starts with its own contiguous run of that order. Threads take
+// tiles from the front of their run and, once it is empty, steal from the back of another thread's, so
+// cheap tiles (a packet that hits at once) and expensive ones (background marching all MAX_STEPS) even out.
+// Every tile is timed; records() and write() give the last run for analysis.
+
+struct Tile {
+    int left, top, right, bottom;                                   // pixels [left, right) x [top, bottom), rows top to bottom
+};
+
+struct TileRecord {
+    Tile tile;
+    int thread = 0;                                                 // worker that rendered it
+    bool stolen = false;                                            // taken from another worker's run
+    double startMs = 0.0;                                           // since the start of run()
+    double ms = 0.0;
+};
+
+class TileScheduler {
+    // a worker's remaining run of tile indices, begin in the low and end in the high 32 bits, so the owner
+    // popping the front and thieves popping the back each need one compare-exchange
+    struct alignas(64) Queue {
+        std::atomic<uint64_t> range = 0;
+    };
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<Queue[]> queues;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    uint64_t generation = 0;                                        // bumped per run so workers run each one once
+    size_t running = 0;                                             // workers still inside the current run
+    bool stopping = false;
+
+    // current run
+    const std::function<void(const Tile&)>* body = nullptr;
+    std::vector<Tile> tiles;                                        // Morton order
+    std::vector<TileRecord> tileRecords;                            // same order
+    std::chrono::steady_clock::time_point runStart;
+    double runMs = 0.0;
+
+    void work(size_t thread, bool pin);
+    bool pop(size_t queue, bool back, uint32_t& index);
+
+public:
+    int tileSize = 32;
+
+    explicit TileScheduler(size_t threads = 0, bool pin = false);   // 0 = one per hardware thread; pin = worker i on CPU i
+    ~TileScheduler();
+    TileScheduler(const TileScheduler&) = delete;
+    TileScheduler& operator=(const TileScheduler&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // calls body once per tile of a width x height image across the workers, returns when every tile is done
+    void run(int width, int height, const std::function<void(const Tile&)>& body);
+
+    const std::vector<TileRecord>& records() const { return tileRecords; }   // of the last run, Morton order
+    std::string summary() const;                                    // one line: time, steals, worker utilisation
+    bool writeCSV(const std::string& path) const;                   // one row per tile
+    bool writeJSON(const std::string& path) const;                  // per worker totals and every tile
+    bool write(const std::string& path) const;                      // by extension, .json or .csv
+};
+
+#endif
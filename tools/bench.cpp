@@ -0,0 +1,251 @@
+// Benchmark: renders every rendering shader headless over a fixed iTime sequence at several resolutions, with and
+// without lighting, and compares ms/frame against a baseline JSON.
+//   benchmark [--shader NAME]... [--size WxH]... [--frames N] [--warmup N] [--baseline FILE] [--threshold PCT]
+//             [--out FILE] [--update-baseline] [--checkerboard] [--spheres N] [--shaders-from-disk]
+// Exits with 1 when any case is more than --threshold percent (default 10) slower than its baseline.
+// Without a baseline file the results are written there, so the first run on a machine records its baseline.
+// Baselines are per machine (benchmarks/ is not committed), comparing against one recorded on another renderer fails.
+// --checkerboard adds a checkerboard-rendered case (see checkerboard.h) next to every full-rate one.
+// --spheres N animates and uploads a field of N spheres every frame (see sphere_scene.h), cases get "/spheres=N".
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "headless_context.h"
+#include "shader_registry.h"
+#include "frame_constants.h"
+#include "scene.h"
+#include "fullscreen_quad.h"
+#include "render_target.h"
+#include "checkerboard.h"
+
+
+struct BenchResult {
+    std::string name;                                               // "<shader>/<W>x<H>/lighting=<0|1>[/checkerboard]"
+    double ms = 0.0;                                                // mean per frame
+    double stddev = 0.0;
+    double min = 0.0, max = 0.0;
+    double mpixPerSecond = 0.0;
+};
+
+// iTime of frame i, the same on every run and machine, spread over the animation rather than one pose
+float frameTime(int frame) {
+    return frame * 0.25f;
+}
+
+bool writeResults(const std::string& path, const std::string& renderer, int frames, const std::vector<BenchResult>& results) {
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+
+    std::ofstream out(path);
+    out << "{\n  \"renderer\": \"" << renderer << "\",\n  \"frames\": " << frames << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        out << "    {\"case\": \"" << r.name << "\", \"ms\": " << r.ms << ", \"stddev\": " << r.stddev
+            << ", \"min\": " << r.min << ", \"max\": " << r.max << ", \"mpix_per_s\": " << r.mpixPerSecond << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+struct Baseline {
+    std::string renderer;                                           // GL_RENDERER it was recorded on
+    std::map<std::string, double> ms;                               // "case" -> ms
+};
+
+// Reads the renderer and the "case" -> "ms" pairs back from a file written by writeResults()
+Baseline readBaseline(const std::string& path) {
+    Baseline baseline;
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    std::string json = text.str();
+
+    const std::string rendererKey = "\"renderer\": \"", caseKey = "\"case\": \"", msKey = "\"ms\": ";
+    size_t renderer = json.find(rendererKey);
+    if (renderer != std::string::npos) {
+        renderer += rendererKey.size();
+        size_t end = json.find('"', renderer);
+        if (end != std::string::npos) baseline.renderer = json.substr(renderer, end - renderer);
+    }
+
+    for (size_t at = json.find(caseKey); at != std::string::npos; at = json.find(caseKey, at)) {
+        at += caseKey.size();
+        size_t end = json.find('"', at);
+        size_t ms = json.find(msKey, end);
+        if (end == std::string::npos || ms == std::string::npos) break;
+        baseline.ms[json.substr(at, end - at)] = std::atof(json.c_str() + ms + msKey.size());
+    }
+    return baseline;
+}
+
+
+int main(int argc, char** argv) {
+    std::vector<std::string> names;
+    std::vector<std::pair<int, int>> sizes;
+    int frames = 10, warmup = 2;
+    std::string baselinePath = "benchmarks/baseline.json";
+    std::string outPath;
+    double threshold = 10.0;
+    bool updateBaseline = false;
+    bool checkerboard = false;
+    int sphereCount = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        int w, h;
+        if (arg == "--shader" && hasValue) names.push_back(argv[++i]);
+        else if (arg == "--size" && hasValue && sscanf(argv[++i], "%dx%d", &w, &h) == 2) sizes.push_back({w, h});
+        else if (arg == "--frames" && hasValue) frames = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--warmup" && hasValue) warmup = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+        else if (arg == "--threshold" && hasValue) threshold = std::stod(argv[++i]);
+        else if (arg == "--out" && hasValue) outPath = argv[++i];
+        else if (arg == "--update-baseline") updateBaseline = true;
+        else if (arg == "--checkerboard") checkerboard = true;
+        else if (arg == "--spheres" && hasValue) sphereCount = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "--shaders-from-disk") ShaderPreprocessor::readFromDisk = true;
+        else {
+            std::cout << "usage: benchmark [--shader NAME]... [--size WxH]... [--frames N] [--warmup N] [--baseline FILE] [--threshold PCT]\n"
+                         "                 [--out FILE] [--update-baseline] [--checkerboard] [--spheres N] [--shaders-from-disk]" << std::endl;
+            return 1;
+        }
+    }
+    if (sizes.empty()) sizes = {{600, 600}, {1920, 1080}, {3840, 2160}};
+
+
+    // ---- INIT CONTEXT --------------------------------------
+    HeadlessContext context;
+    if (!context.valid()) return -1;
+    std::string renderer = (const char*)glGetString(GL_RENDERER);
+    std::cout << "Renderer: " << renderer << " | " << glGetString(GL_VERSION) << std::endl;
+
+    FrameConstants frameConstants;
+    Scene scene;
+    SphereScene spheres(sphereCount);
+    // permutation index = lighting + 2 * checkerboard
+    ShaderRegistry registry("shaders/default.vert", "shaders/rendering", {"raytrace", "raymarch", "coolRaymarch"},
+                            {{{"LIGHTING", "0"}}, {{"LIGHTING", "1"}},
+                             {{"LIGHTING", "0"}, {"CHECKERBOARD", "1"}}, {{"LIGHTING", "1"}, {"CHECKERBOARD", "1"}}});
+    if (names.empty()) {
+        for (size_t i = 0; i < registry.size(); i++) names.push_back(registry.name(i));
+    }
+
+    FullscreenQuad quad;
+    RenderTarget target(sizes[0].first, sizes[0].second);
+    CheckerboardRenderer checker(sizes[0].first, sizes[0].second);
+
+
+    // ---- BENCHMARK --------------------------------------
+    std::vector<BenchResult> results;
+    for (const std::string& name : names) {
+        size_t index = registry.find(name);
+        if (index == registry.size()) {
+            std::cout << "ERROR::BENCH::UNKNOWN_SHADER " << name << std::endl;
+            return 1;
+        }
+
+        for (auto [width, height] : sizes) {
+            target.resize(width, height);
+
+            for (size_t permutation = 0; permutation < (checkerboard ? 4u : 2u); permutation++) {
+                size_t lighting = permutation % 2;
+                bool checkered = permutation >= 2;
+                Shader* shader = registry.get(index, permutation);
+                if (shader->wait() != ShaderStatus::Ready) return 1;
+
+                // glFinish after every frame, so each sample is the full cost of one frame and nothing overlaps
+                std::vector<double> samples;
+                for (int frame = -warmup; frame < frames; frame++) {
+                    auto start = std::chrono::steady_clock::now();
+
+                    FrameConstantsData constants;
+                    constants.iResolution[0] = (float)width;
+                    constants.iResolution[1] = (float)height;
+                    constants.iTime = frameTime(std::max(frame, 0));
+                    if (checkered) {
+                        checker.begin(shader, width, height);
+                        constants.iFrame = checker.frameIndex();
+                        checker.halfTarget().bind();
+                    }
+                    else target.bind();
+
+                    spheres.animate(constants.iTime);
+                    frameConstants.update(constants);
+                    scene.update(spheres);
+                    shader->use();
+                    quad.draw();
+                    if (checkered) checker.resolve(quad);
+                    glFinish();
+                    if (frame >= 0) samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                }
+
+                BenchResult r;
+                r.name = name + "/" + std::to_string(width) + "x" + std::to_string(height) + "/lighting=" + std::to_string(lighting);
+                if (checkered) r.name += "/checkerboard";
+                if (sphereCount > 0) r.name += "/spheres=" + std::to_string(sphereCount);
+                for (double s : samples) r.ms += s;
+                r.ms /= samples.size();
+                for (double s : samples) r.stddev += (s - r.ms) * (s - r.ms);
+                r.stddev = std::sqrt(r.stddev / samples.size());
+                r.min = *std::min_element(samples.begin(), samples.end());
+                r.max = *std::max_element(samples.begin(), samples.end());
+                r.mpixPerSecond = (double)width * height / (r.ms * 1000.0);
+                results.push_back(r);
+
+                printf("%-48s %9.3f ms +- %7.3f  %9.2f Mpix/s\n", r.name.c_str(), r.ms, r.stddev, r.mpixPerSecond);
+                fflush(stdout);
+            }
+        }
+    }
+
+    if (!outPath.empty()) writeResults(outPath, renderer, frames, results);
+
+
+    // ---- COMPARE --------------------------------------
+    if (updateBaseline || !std::filesystem::exists(baselinePath)) {
+        if (!writeResults(baselinePath, renderer, frames, results)) {
+            std::cout << "ERROR::BENCH::FAILED TO WRITE " << baselinePath << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote baseline " << baselinePath << std::endl;
+        return 0;
+    }
+
+    // timings from another GPU or driver say nothing about this change
+    Baseline baseline = readBaseline(baselinePath);
+    if (baseline.renderer != renderer) {
+        std::cout << "ERROR::BENCH::RENDERER_MISMATCH " << baselinePath << " was recorded on \"" << baseline.renderer
+                  << "\", this is \"" << renderer << "\"; re-record it with --update-baseline or pass another --baseline" << std::endl;
+        return 1;
+    }
+
+    int regressions = 0;
+    std::cout << "\nAgainst " << baselinePath << " (threshold " << threshold << "%):" << std::endl;
+    for (const BenchResult& r : results) {
+        auto it = baseline.ms.find(r.name);
+        if (it == baseline.ms.end() || it->second <= 0.0) {
+            printf("%-48s no baseline\n", r.name.c_str());
+            continue;
+        }
+
+        double change = (r.ms / it->second - 1.0) * 100.0;
+        bool regressed = change > threshold;
+        regressions += regressed;
+        printf("%-48s %9.3f -> %9.3f ms  %+7.1f%%%s\n", r.name.c_str(), it->second, r.ms, change, regressed ? "  REGRESSION" : "");
+    }
+
+    if (regressions) std::cout << regressions << " case(s) regressed by more than " << threshold << "%" << std::endl;
+    return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+// Build step: embed_shaders <output.cpp> <file>...
+// Writes a translation unit defining embeddedShaders[] (see embedded_shaders.h) with every input file.
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+// C++ string literal pieces, one per source line so the generated file stays readable
+static std::string literal(const std::string& data) {
+    std::string out = "\"";
+    for (unsigned char c : data) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\t': out += "\\t"; break;
+            case '\r': out += "\\r"; break;
+            case '\n': out += "\\n\"\n        \""; break;
+            default:
+                if (c < 0x20 || c >= 0x7f) {
+                    char octal[5];
+                    snprintf(octal, sizeof(octal), "\\%03o", c);
+                    out += octal;
+                } else {
+                    out += (char)c;
+                }
+        }
+    }
+    return out + "\"sv";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cout << "usage: embed_shaders <output.cpp> <file>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> paths(argv + 2, argv + argc);
+    std::sort(paths.begin(), paths.end());                          // lookups binary search by path
+
+    std::ostringstream out;
+    out << "// Generated by tools/embed_shaders.cpp, do not edit\n"
+        << "#include \"embedded_shaders.h\"\n\n"
+        << "using namespace std::string_view_literals;\n\n"
+        << "constexpr EmbeddedShader embeddedShaders[] = {\n";
+
+    for (const std::string& path : paths) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cout << "embed_shaders: failed to read " << path << std::endl;
+            return 1;
+        }
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        out << "    {" << literal(path) << ",\n        " << literal(data) << "},\n";
+    }
+
+    // an empty array is ill-formed, keep a sentinel that no path can match
+    if (paths.empty()) out << "    {\"\"sv, \"\"sv},\n";
+
+    out << "};\n\n"
+        << "const size_t embeddedShaderCount = " << paths.size() << ";\n";
+
+    std::ofstream file(argv[1], std::ios::binary);
+    file << out.str();
+    return file ? 0 : 1;
+}
@@ -0,0 +1,192 @@
+// Golden image test: renders every rendering shader through a headless GL context and through the CPU reference
+// (see cpu_raytracer.h, cpu_raymarcher.h) at fixed iTime / lighting combinations and compares the two.
+//   golden_test [--shader NAME]... [--size WxH] [--spheres N] [--min-psnr DB] [--max-error N] [--out DIR] [--threads N]
+//               [--shaders-from-disk]
+// A case fails when its PSNR is below --min-psnr (default 50 dB) or any channel differs by more than --max-error
+// (default 4 of 255). Ray marched shaders are rendered by the widest SIMD kernel this CPU runs, compared with the GPU,
+// and by every other available kernel, each of which has to match the widest byte for byte. Failing cases write <out>/<case>_gpu.png, _cpu.png and _diff.png (the error scaled up 16x);
+// exits with 1 when any case failed. `make test` runs it, any change to step counts, epsilons or normals in the
+// shaders has to keep it green or update the CPU port alongside.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "headless_context.h"
+#include "shader_registry.h"
+#include "frame_constants.h"
+#include "scene.h"
+#include "fullscreen_quad.h"
+#include "render_target.h"
+#include "image.h"
+#include "cpu_raytracer.h"
+#include "cpu_raymarcher.h"
+
+
+struct Comparison {
+    double psnr = INFINITY;                                         // dB over RGB, infinite for identical images
+    int maxError = 0;                                               // largest channel difference
+    size_t pixelsOff = 0;                                           // pixels that differ at all
+    Image diff;                                                     // |gpu - cpu| * 16 per channel
+};
+
+Comparison compare(const Image& gpu, const Image& cpu) {
+    Comparison c;
+    c.diff = Image(gpu.width, gpu.height);
+    double squared = 0.0;
+    for (size_t i = 0; i < gpu.pixels.size(); i += 4) {
+        int worst = 0;
+        for (size_t ch = 0; ch < 3; ch++) {
+            int error = std::abs((int)gpu.pixels[i + ch] - (int)cpu.pixels[i + ch]);
+            squared += (double)error * error;
+            worst = std::max(worst, error);
+            c.diff.pixels[i + ch] = (uint8_t)std::min(255, error * 16);
+        }
+        c.diff.pixels[i + 3] = 255;
+        c.maxError = std::max(c.maxError, worst);
+        c.pixelsOff += worst > 0;
+    }
+
+    double mse = squared / ((double)gpu.width * gpu.height * 3);
+    if (mse > 0.0) c.psnr = 10.0 * std::log10(255.0 * 255.0 / mse);
+    return c;
+}
+
+
+int main(int argc, char** argv) {
+    std::vector<std::string> names;
+    int width = 256, height = 256;
+    int sphereCount = 0;
+    double minPsnr = 50.0;
+    int maxError = 4;
+    std::string outDir = "golden_diffs";
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--shader" && hasValue) names.push_back(argv[++i]);
+        else if (arg == "--size" && hasValue && sscanf(argv[++i], "%dx%d", &width, &height) == 2) {}
+        else if (arg == "--spheres" && hasValue) sphereCount = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "--min-psnr" && hasValue) minPsnr = std::stod(argv[++i]);
+        else if (arg == "--max-error" && hasValue) maxError = std::stoi(argv[++i]);
+        else if (arg == "--out" && hasValue) outDir = argv[++i];
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--shaders-from-disk") ShaderPreprocessor::readFromDisk = true;
+        else {
+            std::cout << "usage: golden_test [--shader NAME]... [--size WxH] [--spheres N] [--min-psnr DB] [--max-error N] [--out DIR] [--threads N]\n"
+                         "                   [--shaders-from-disk]" << std::endl;
+            return 1;
+        }
+    }
+    if (names.empty()) names = {"raytrace", "raymarch", "coolRaymarch"};
+    const float times[] = {0.0f, 1.0f, 3.7f};
+    const int timeCount = (int)(sizeof(times) / sizeof(times[0]));
+
+
+    // ---- INIT CONTEXT --------------------------------------
+    HeadlessContext context;
+    if (!context.valid()) return 1;
+    // widest first, the others are checked against it
+    std::vector<cpu::SimdWidth> widths;
+    for (cpu::SimdWidth w : {cpu::SimdWidth::AVX512, cpu::SimdWidth::AVX2, cpu::SimdWidth::SSE, cpu::SimdWidth::Scalar}) {
+        if (cpu::marchKernel(w)) widths.push_back(w);
+    }
+    std::cout << "GPU: " << glGetString(GL_RENDERER) << " | CPU:";
+    for (cpu::SimdWidth w : widths) std::cout << " " << cpu::simdName(w);
+    std::cout << std::endl;
+
+    FrameConstants frameConstants;
+    Scene scene;
+    SphereScene spheres(sphereCount);
+    ShaderRegistry registry("shaders/default.vert", "shaders/rendering", {"raytrace", "raymarch", "coolRaymarch"},
+                            {{{"LIGHTING", "0"}}, {{"LIGHTING", "1"}}});
+    FullscreenQuad quad;
+    RenderTarget target(width, height);
+    TileScheduler scheduler(threads);
+
+
+    // ---- COMPARE --------------------------------------
+    int failures = 0, cases = 0;
+    for (const std::string& name : names) {
+        size_t index = registry.find(name);
+        cpu::MarchScene marchScene;
+        bool marched = cpu::parseMarchScene(name, marchScene);
+        if (index == registry.size() || (name != "raytrace" && !marched)) {
+            std::cout << "ERROR::GOLDEN_TEST::NO_CPU_REFERENCE " << name << std::endl;
+            cases += 2 * timeCount;                                 // every lighting and time case of the shader
+            failures += 2 * timeCount;
+            continue;
+        }
+
+        for (bool lighting : {false, true}) {
+            Shader* shader = registry.get(index, lighting ? 1 : 0);
+            if (shader->wait() != ShaderStatus::Ready) {
+                printf("%s_lighting%d%*s FAILED to compile, %d case(s) skipped\n", name.c_str(), lighting ? 1 : 0,
+                       std::max(0, 26 - (int)name.size()), "", timeCount);
+                cases += timeCount;
+                failures += timeCount;
+                continue;
+            }
+
+            for (float time : times) {
+                FrameConstantsData constants;
+                constants.iResolution[0] = (float)width;
+                constants.iResolution[1] = (float)height;
+                constants.iTime = time;
+                spheres.animate(time);
+
+                target.bind();
+                shader->use();
+                frameConstants.update(constants);
+                scene.update(spheres);
+                quad.draw();
+                Image gpu = target.read();
+                Image cpu = marched ? cpu::renderRaymarch(marchScene, width, height, time, lighting, scheduler, widths[0])
+                                    : cpu::renderRaytrace(spheres, width, height, lighting, scheduler);
+
+                char label[64];
+                snprintf(label, sizeof(label), "%s_t%g_lighting%d", name.c_str(), time, lighting ? 1 : 0);
+                Comparison c = compare(gpu, cpu);
+                bool passed = c.psnr >= minPsnr && c.maxError <= maxError;
+                cases++;
+                printf("%-36s psnr %7.2f dB  max error %3d  pixels off %6zu  %s\n", label, c.psnr, c.maxError, c.pixelsOff, passed ? "ok" : "FAILED");
+                fflush(stdout);
+                if (!passed) {
+                    failures++;
+                    std::filesystem::create_directories(outDir);
+                    std::string base = outDir + "/" + label;
+                    writeImage(base + "_gpu.png", gpu);
+                    writeImage(base + "_cpu.png", cpu);
+                    writeImage(base + "_diff.png", c.diff);
+                }
+
+                for (size_t w = 1; marched && w < widths.size(); w++) {
+                    Image narrow = cpu::renderRaymarch(marchScene, width, height, time, lighting, scheduler, widths[w]);
+                    Comparison n = compare(cpu, narrow);
+                    bool identical = narrow.pixels == cpu.pixels;
+                    char narrowLabel[80];
+                    snprintf(narrowLabel, sizeof(narrowLabel), "%s_%s", label, cpu::simdName(widths[w]));
+                    cases++;
+                    printf("%-36s vs %-6s                  pixels off %6zu  %s\n", narrowLabel, cpu::simdName(widths[0]), n.pixelsOff,
+                           identical ? "ok" : "FAILED");
+                    fflush(stdout);
+                    if (identical) continue;
+
+                    failures++;
+                    std::filesystem::create_directories(outDir);
+                    writeImage(outDir + "/" + narrowLabel + ".png", narrow);
+                    writeImage(outDir + "/" + narrowLabel + "_diff.png", n.diff);
+                }
+            }
+        }
+    }
+
+    if (failures) std::cout << failures << " of " << cases << " case(s) failed (min psnr " << minPsnr << " dB, max error " << maxError << "), images in " << outDir << std::endl;
+    else std::cout << "All " << cases << " cases passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// Tiled still renderer for images larger than a single draw (driver watchdogs) or than memory.
+//   poster [--shader NAME] [--size WxH] [--tile N] [--time T] [--lighting] [--spheres N] [--samples N] [--out FILE.ppm]
+//          [--shaders-from-disk]
+// The image is drawn in N x N tiles (default 512), each its own draw into a small target with iTileOffset telling the
+// shader where the tile sits, so cameraRay sees global pixel coordinates. Finished tiles are copied straight into
+// a memory-mapped PPM one band of tile rows at a time (see mapped_image.h); memory use depends on the width and
+// tile size only, never on the height.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "headless_context.h"
+#include "shader_registry.h"
+#include "frame_constants.h"
+#include "scene.h"
+#include "fullscreen_quad.h"
+#include "render_target.h"
+#include "accumulator.h"
+#include "mapped_image.h"
+
+
+int main(int argc, char** argv) {
+    std::string name = "coolRaymarch";
+    int width = 8192, height = 8192;
+    int tile = 512;
+    float time = 0.0f;
+    bool lighting = false;
+    int sphereCount = 0;
+    int samples = 1;
+    std::string out = "poster.ppm";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--shader" && hasValue) name = argv[++i];
+        else if (arg == "--size" && hasValue && sscanf(argv[++i], "%dx%d", &width, &height) == 2) {}
+        else if (arg == "--tile" && hasValue) tile = std::max(16, std::stoi(argv[++i]));
+        else if (arg == "--time" && hasValue) time = std::stof(argv[++i]);
+        else if (arg == "--lighting") lighting = true;
+        else if (arg == "--spheres" && hasValue) sphereCount = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "--samples" && hasValue) samples = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--out" && hasValue) out = argv[++i];
+        else if (arg == "--shaders-from-disk") ShaderPreprocessor::readFromDisk = true;
+        else {
+            std::cout << "usage: poster [--shader NAME] [--size WxH] [--tile N] [--time T] [--lighting] [--spheres N] [--samples N] [--out FILE.ppm]\n"
+                         "              [--shaders-from-disk]" << std::endl;
+            return 1;
+        }
+    }
+
+
+    // ---- INIT CONTEXT --------------------------------------
+    HeadlessContext context;
+    if (!context.valid()) return -1;
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << " | " << glGetString(GL_VERSION) << std::endl;
+
+    FrameConstants frameConstants;
+    Scene scene;
+    SphereScene spheres(sphereCount);
+    spheres.animate(time);
+    scene.update(spheres);
+    ShaderRegistry registry("shaders/default.vert", "shaders/rendering", {"raytrace", "raymarch", "coolRaymarch"},
+                            {{{"LIGHTING", "0"}}, {{"LIGHTING", "1"}}});
+    size_t index = registry.find(name);
+    if (index == registry.size()) {
+        std::cout << "ERROR::POSTER::UNKNOWN_SHADER " << name << std::endl;
+        return 1;
+    }
+    Shader* shader = registry.get(index, lighting ? 1 : 0);
+    if (shader->wait() != ShaderStatus::Ready) return 1;
+
+    MappedImage image(out, width, height);
+    if (!image.valid()) return 1;
+
+    FullscreenQuad quad;
+    RenderTarget target(tile, tile);
+    std::unique_ptr<Accumulator> accumulator;
+    if (samples > 1) accumulator = std::make_unique<Accumulator>(tile, tile);
+    std::vector<uint8_t> pixels((size_t)tile * tile * 4);
+
+
+    // ---- RENDER TILES --------------------------------------
+    auto begin = std::chrono::steady_clock::now();
+    for (int top = 0; top < height; top += tile) {
+        int rows = std::min(tile, height - top);
+        uint8_t* band = image.mapRows(top, rows);
+        if (!band) return 1;
+
+        for (int left = 0; left < width; left += tile) {
+            int columns = std::min(tile, width - left);
+
+            // GL counts rows from the bottom of the image, the file from the top
+            FrameConstantsData constants;
+            constants.iResolution[0] = (float)width;
+            constants.iResolution[1] = (float)height;
+            constants.iTime = time;
+            constants.iTileOffset[0] = (float)left;
+            constants.iTileOffset[1] = (float)(height - top - rows);
+
+            // edge tiles only cover part of the target
+            if (accumulator) {
+                accumulator->reset();
+                for (int s = 0; s < samples; s++) {
+                    accumulator->jitter(constants.iJitter[0], constants.iJitter[1]);
+                    accumulator->sampleTarget().bind();
+                    glViewport(0, 0, columns, rows);
+                    shader->use();
+                    frameConstants.update(constants);
+                    quad.draw();
+                    accumulator->accumulate(quad);
+                }
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, accumulator->result().framebuffer());
+            } else {
+                target.bind();
+                glViewport(0, 0, columns, rows);
+                shader->use();
+                frameConstants.update(constants);
+                quad.draw();
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, target.framebuffer());
+            }
+
+            // one tile per submission, the readback waits for it before the next one is queued
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, columns, rows, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+            for (int y = 0; y < rows; y++) {
+                const uint8_t* src = pixels.data() + (size_t)(rows - 1 - y) * columns * 4;
+                uint8_t* dst = band + (size_t)y * image.rowBytes() + (size_t)left * 3;
+                for (int x = 0; x < columns; x++) {
+                    dst[x * 3 + 0] = src[x * 4 + 0];
+                    dst[x * 3 + 1] = src[x * 4 + 1];
+                    dst[x * 3 + 2] = src[x * 4 + 2];
+                }
+            }
+        }
+
+        if (!image.flush()) {
+            std::cout << "ERROR::POSTER::FAILED TO WRITE rows " << top << "-" << top + rows << std::endl;
+            return 1;
+        }
+        printf("\rrows %d/%d", top + rows, height);
+        fflush(stdout);
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    printf("\nWrote %s, %dx%d in %.1f s (%.2f Mpix/s)\n", out.c_str(), width, height, seconds, (double)width * height / seconds / 1.0e6);
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Offline recorder: renders a shader at a fixed timestep and exports the frames as an image sequence or a Y4M video,
+// reading them back asynchronously (see frame_exporter.h) so throughput is bound by rendering, not readback.
+//   record [--shader NAME] [--size WxH] [--fps N] [--frames N | --duration S] [--start T] [--lighting] [--spheres N]
+//          [--format png|ppm|y4m] [--out PATH] [--sync] [--shaders-from-disk]
+// Frame i is rendered at iTime = start + i / fps. PATH is a directory for png/ppm and a file for y4m.
+// --sync reads every frame back with a blocking glReadPixels and encodes it inline, for comparison.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "headless_context.h"
+#include "shader_registry.h"
+#include "frame_constants.h"
+#include "scene.h"
+#include "fullscreen_quad.h"
+#include "render_target.h"
+#include "frame_exporter.h"
+#include "image.h"
+
+
+int main(int argc, char** argv) {
+    std::string name = "coolRaymarch";
+    int width = 1280, height = 720;
+    int fps = 30;
+    int frames = 0;
+    float duration = 4.0f, start = 0.0f;
+    bool lighting = false;
+    int sphereCount = 0;
+    bool sync = false;
+    ExportFormat format = ExportFormat::PNG;
+    std::string out;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--shader" && hasValue) name = argv[++i];
+        else if (arg == "--size" && hasValue && sscanf(argv[++i], "%dx%d", &width, &height) == 2) {}
+        else if (arg == "--fps" && hasValue) fps = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--frames" && hasValue) frames = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--duration" && hasValue) duration = std::stof(argv[++i]);
+        else if (arg == "--start" && hasValue) start = std::stof(argv[++i]);
+        else if (arg == "--lighting") lighting = true;
+        else if (arg == "--spheres" && hasValue) sphereCount = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "--format" && hasValue && FrameExporter::parse(argv[++i], format)) {}
+        else if (arg == "--out" && hasValue) out = argv[++i];
+        else if (arg == "--sync") sync = true;
+        else if (arg == "--shaders-from-disk") ShaderPreprocessor::readFromDisk = true;
+        else {
+            std::cout << "usage: record [--shader NAME] [--size WxH] [--fps N] [--frames N | --duration S] [--start T] [--lighting] [--spheres N]\n"
+                         "              [--format png|ppm|y4m] [--out PATH] [--sync] [--shaders-from-disk]" << std::endl;
+            return 1;
+        }
+    }
+    if (frames == 0) frames = std::max(1, (int)(duration * fps + 0.5f));
+    if (out.empty()) out = format == ExportFormat::Y4M ? name + ".y4m" : name;
+    if (sync && format == ExportFormat::Y4M) {
+        std::cout << "ERROR::RECORD::--sync only writes png or ppm sequences" << std::endl;
+        return 1;
+    }
+
+
+    // ---- INIT CONTEXT --------------------------------------
+    HeadlessContext context;
+    if (!context.valid()) return -1;
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << " | " << glGetString(GL_VERSION) << std::endl;
+
+    FrameConstants frameConstants;
+    Scene scene;
+    SphereScene spheres(sphereCount);
+    ShaderRegistry registry("shaders/default.vert", "shaders/rendering", {"raytrace", "raymarch", "coolRaymarch"},
+                            {{{"LIGHTING", "0"}}, {{"LIGHTING", "1"}}});
+    size_t index = registry.find(name);
+    if (index == registry.size()) {
+        std::cout << "ERROR::RECORD::UNKNOWN_SHADER " << name << std::endl;
+        return 1;
+    }
+    Shader* shader = registry.get(index, lighting ? 1 : 0);
+    if (shader->wait() != ShaderStatus::Ready) return 1;
+
+    FullscreenQuad quad;
+    RenderTarget target(width, height);
+    FrameExporter exporter(out, format, width, height, fps);
+
+
+    // ---- RECORD --------------------------------------
+    auto begin = std::chrono::steady_clock::now();
+    size_t failures = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        FrameConstantsData constants;
+        constants.iResolution[0] = (float)width;
+        constants.iResolution[1] = (float)height;
+        constants.iTime = start + (float)frame / fps;
+        spheres.animate(constants.iTime);
+
+        target.bind();
+        shader->use();
+        frameConstants.update(constants);
+        scene.update(spheres);
+        quad.draw();
+
+        if (!sync) {
+            exporter.capture(target);
+            continue;
+        }
+
+        // reference path: stall on the readback, then encode on this thread
+        char file[32];
+        snprintf(file, sizeof(file), "/frame_%05d.%s", frame, format == ExportFormat::PNG ? "png" : "ppm");
+        if (!writeImage(out + file, target.read())) failures++;
+    }
+    failures += exporter.finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    printf("%d frames at %dx%d in %.2f s, %.2f frames/s -> %s\n", frames, width, height, seconds, frames / seconds, out.c_str());
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// Headless renderer: draws rendering shaders into an offscreen framebuffer and writes images, no window or GPU needed.
+//   render [--shader NAME]... [--size WxH] [--time T] [--lighting] [--spheres N] [--samples N] [--out DIR] [--format png|ppm]
+//          [--cpu] [--threads N] [--pin] [--simd scalar|sse|avx2|avx512] [--tile-stats FILE] [--shaders-from-disk]
+// Renders every shader in shaders/rendering when no --shader is given. Files are written as <out>/<name>.<format>.
+// --samples N averages N jittered frames (see accumulator.h) for anti-aliased stills.
+// --spheres N replaces the two balls of raytrace with a field of N spheres (see sphere_scene.h).
+// --cpu renders with the C++ ports of the shaders instead (see cpu_raytracer.h, cpu_raymarcher.h), no GL context is
+// created; --threads N sets the worker count, one per hardware thread by default, --pin ties worker i to CPU i,
+// --simd the ray packet width and --tile-stats FILE.csv|.json exports per-tile timings (see tile_scheduler.h),
+// with the shader name added before the extension when rendering more than one.
+
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "headless_context.h"
+#include "shader_registry.h"
+#include "frame_constants.h"
+#include "scene.h"
+#include "fullscreen_quad.h"
+#include "render_target.h"
+#include "accumulator.h"
+#include "image.h"
+#include "cpu_raytracer.h"
+#include "cpu_raymarcher.h"
+
+
+int main(int argc, char** argv) {
+    std::vector<std::string> names;
+    int width = 600, height = 600;
+    float time = 0.0f;
+    bool lighting = false;
+    int sphereCount = 0;
+    int samples = 1;
+    std::string outDir = ".";
+    std::string format = "png";
+    bool cpu = false;
+    int threads = 0;
+    bool pin = false;
+    std::string tileStats;
+    cpu::SimdWidth simd = cpu::bestSimdWidth();
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--shader" && hasValue) names.push_back(argv[++i]);
+        else if (arg == "--size" && hasValue && sscanf(argv[++i], "%dx%d", &width, &height) == 2) {}
+        else if (arg == "--time" && hasValue) time = std::stof(argv[++i]);
+        else if (arg == "--lighting") lighting = true;
+        else if (arg == "--spheres" && hasValue) sphereCount = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "--samples" && hasValue) samples = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--out" && hasValue) outDir = argv[++i];
+        else if (arg == "--format" && hasValue) format = argv[++i];
+        else if (arg == "--cpu") cpu = true;
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--pin") pin = true;
+        else if (arg == "--simd" && hasValue && cpu::parseSimdWidth(argv[++i], simd)) {}
+        else if (arg == "--tile-stats" && hasValue) tileStats = argv[++i];
+        else if (arg == "--shaders-from-disk") ShaderPreprocessor::readFromDisk = true;
+        else {
+            std::cout << "usage: render [--shader NAME]... [--size WxH] [--time T] [--lighting] [--spheres N] [--samples N] [--out DIR] [--format png|ppm]\n"
+                         "              [--cpu] [--threads N] [--pin] [--simd scalar|sse|avx2|avx512] [--tile-stats FILE] [--shaders-from-disk]" << std::endl;
+            return 1;
+        }
+    }
+    std::error_code error;
+    std::filesystem::create_directories(outDir, error);
+    if (error) {
+        std::cout << "ERROR::RENDER::FAILED TO CREATE " << outDir << ": " << error.message() << std::endl;
+        return 1;
+    }
+
+    SphereScene spheres(sphereCount);
+    spheres.animate(time);
+
+
+    // ---- CPU REFERENCE --------------------------------------
+    if (cpu) {
+        if (names.empty()) names = {"raytrace", "raymarch", "coolRaymarch"};
+        if (samples > 1) std::cout << "--samples is ignored with --cpu" << std::endl;
+        if (!cpu::marchKernel(simd)) {
+            std::cout << "--simd " << cpu::simdName(simd) << " is not available, using scalar" << std::endl;
+            simd = cpu::SimdWidth::Scalar;
+        }
+        TileScheduler scheduler(threads, pin);
+        std::cout << "Renderer: CPU, " << scheduler.size() << " thread(s), " << cpu::simdName(simd) << std::endl;
+
+        int failures = 0;
+        for (const std::string& name : names) {
+            cpu::MarchScene scene;
+            Image image;
+            if (name == "raytrace") image = cpu::renderRaytrace(spheres, width, height, lighting, scheduler);
+            else if (cpu::parseMarchScene(name, scene)) image = cpu::renderRaymarch(scene, width, height, time, lighting, scheduler, simd);
+            else {
+                std::cout << "ERROR::RENDER::NO_CPU_PORT " << name << std::endl;
+                failures++;
+                continue;
+            }
+            std::cout << name << ": " << scheduler.summary() << std::endl;
+
+            std::string path = outDir + "/" + name + "." + format;
+            if (writeImage(path, image)) std::cout << "Wrote " << path << std::endl;
+            else failures++;
+
+            if (!tileStats.empty()) {
+                std::string statsPath = tileStats;
+                size_t dot = statsPath.find_last_of('.');
+                if (names.size() > 1) statsPath.insert(dot == std::string::npos ? statsPath.size() : dot, "_" + name);
+                if (!scheduler.write(statsPath)) failures++;
+            }
+        }
+        return failures == 0 ? 0 : 1;
+    }
+
+
+    // ---- INIT CONTEXT --------------------------------------
+    HeadlessContext context;
+    if (!context.valid()) return -1;
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << " | " << glGetString(GL_VERSION) << std::endl;
+
+    FrameConstants frameConstants;
+    Scene scene;
+    scene.update(spheres);
+    ShaderRegistry registry("shaders/default.vert", "shaders/rendering", {"raytrace", "raymarch", "coolRaymarch"},
+                            {{{"LIGHTING", "0"}}, {{"LIGHTING", "1"}}});
+    if (names.empty()) {
+        for (size_t i = 0; i < registry.size(); i++) names.push_back(registry.name(i));
+    }
+
+    FullscreenQuad quad;
+    RenderTarget target(width, height);
+    std::unique_ptr<Accumulator> accumulator;
+    if (samples > 1) accumulator = std::make_unique<Accumulator>(width, height);
+
+
+    // ---- RENDER --------------------------------------
+    int failures = 0;
+    for (const std::string& name : names) {
+        size_t index = registry.find(name);
+        if (index == registry.size()) {
+            std::cout << "ERROR::RENDER::UNKNOWN_SHADER " << name << std::endl;
+            failures++;
+            continue;
+        }
+
+        Shader* shader = registry.get(index, lighting ? 1 : 0);
+        if (shader->wait() != ShaderStatus::Ready) {
+            failures++;
+            continue;
+        }
+
+        FrameConstantsData constants;
+        constants.iResolution[0] = (float)width;
+        constants.iResolution[1] = (float)height;
+        constants.iTime = time;
+
+        if (!accumulator) {
+            target.bind();
+            shader->use();
+            frameConstants.update(constants);
+            quad.draw();
+        }
+        else {
+            accumulator->begin({shader, time, width, height});
+            for (int s = 0; s < samples; s++) {
+                accumulator->jitter(constants.iJitter[0], constants.iJitter[1]);
+                accumulator->sampleTarget().bind();
+                shader->use();
+                frameConstants.update(constants);
+                quad.draw();
+                accumulator->accumulate(quad);
+            }
+        }
+
+        std::string path = outDir + "/" + name + "." + format;
+        if (writeImage(path, accumulator ? accumulator->result().read() : target.read())) std::cout << "Wrote " << path << std::endl;
+        else failures++;
+    }
+
+    return failures == 0 ? 0 : 1;
+}